@@ -0,0 +1,804 @@
+// Benchmark suite for the maze core, in the spirit of Google Benchmark: each
+// benchmark is run with a growing iteration count until it has been timed for
+// at least --min-time seconds. All mazes and move sequences use fixed seeds, so
+// two runs on the same commit measure exactly the same work.
+//
+//   mazeBench [--filter TEXT] [--max-size N] [--min-time SECONDS]
+//             [--format console|json|csv] [--out FILE]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "core/FrameBuffer.h"
+#include "core/GridKernels.h"
+#include "core/LayeredMaze.h"
+#include "core/Maze.h"
+#include "core/ScoreStore.h"
+#include "core/TopK.h"
+
+using namespace std;
+using namespace chrono;
+
+static const uint64_t MAZE_SEED = 42;
+static const uint64_t MOVE_SEED = 7;
+
+// Hardware cache-miss counter for this thread (last-level misses as the CPU
+// reports them). Only on Linux, and only where the kernel exposes hardware
+// events; virtual machines often do not, and then available() is false.
+class CacheMissCounter
+{
+private:
+    int fd;
+
+public:
+    CacheMissCounter() : fd(-1)
+    {
+#ifdef __linux__
+        perf_event_attr attr = {};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~CacheMissCounter()
+    {
+#ifdef __linux__
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+#endif
+    }
+
+    CacheMissCounter(const CacheMissCounter &) = delete;
+    CacheMissCounter &operator=(const CacheMissCounter &) = delete;
+
+    bool available() const { return fd >= 0; }
+
+    void start()
+    {
+#ifdef __linux__
+        if (fd >= 0)
+        {
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void stop()
+    {
+#ifdef __linux__
+        if (fd >= 0)
+        {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+#endif
+    }
+
+    // Misses counted while started so far.
+    long long read() const
+    {
+        long long count = 0;
+#ifdef __linux__
+        if (fd >= 0 && ::read(fd, &count, sizeof(count)) != sizeof(count))
+        {
+            count = 0;
+        }
+#endif
+        return count;
+    }
+};
+
+// Timing state handed to a benchmark body. The body loops while keepRunning()
+// returns true and may exclude setup work with pauseTiming()/resumeTiming().
+class BenchState
+{
+private:
+    long long iterations;
+    long long done;
+    high_resolution_clock::time_point started;
+    double elapsed;
+    bool paused;
+    unique_ptr<CacheMissCounter> misses;
+
+public:
+    double itemsPerIteration;
+    // Extra memory the benchmarked code holds on to, reported when non-zero.
+    double bytes;
+
+    explicit BenchState(long long iterations)
+        : iterations(iterations), done(0), elapsed(0.0), paused(true), itemsPerIteration(0.0), bytes(0.0) {}
+
+    // Also counts cache misses while timed, where the hardware allows it.
+    void countCacheMisses()
+    {
+        misses = make_unique<CacheMissCounter>();
+        if (!paused)
+        {
+            misses->start();
+        }
+    }
+
+    bool keepRunning()
+    {
+        if (done == 0 && paused)
+        {
+            resumeTiming();
+        }
+        if (done++ < iterations)
+        {
+            return true;
+        }
+        pauseTiming();
+        return false;
+    }
+
+    void pauseTiming()
+    {
+        if (!paused)
+        {
+            elapsed += duration<double>(high_resolution_clock::now() - started).count();
+            paused = true;
+            if (misses)
+            {
+                misses->stop();
+            }
+        }
+    }
+
+    void resumeTiming()
+    {
+        if (paused)
+        {
+            if (misses)
+            {
+                misses->start();
+            }
+            started = high_resolution_clock::now();
+            paused = false;
+        }
+    }
+
+    double seconds() const { return elapsed; }
+    // Cache misses counted so far, or -1 if they were not counted.
+    long long cacheMisses() const { return misses && misses->available() ? misses->read() : -1; }
+    long long getIterations() const { return iterations; }
+};
+
+struct Benchmark
+{
+    string name;
+    function<void(BenchState &)> body;
+};
+
+struct Result
+{
+    string name;
+    long long iterations;
+    double nsPerIteration;
+    double itemsPerSecond;
+    double bytes;
+    double missesPerIteration; // negative when not counted
+};
+
+struct Size
+{
+    int rows;
+    int cols;
+};
+
+static string sizeName(const Size &size)
+{
+    return to_string(size.rows) + "x" + to_string(size.cols);
+}
+
+static void benchGenerate(BenchState &state, Size size, Generator generator)
+{
+    Maze maze;
+    while (state.keepRunning())
+    {
+        maze.init(size.rows, size.cols, generator, MAZE_SEED);
+    }
+    state.itemsPerIteration = double(maze.getRows()) * maze.getCols();
+    state.bytes = double(maze.getGeneratorScratchBytes());
+}
+
+// A built-in difficulty with a new seed every iteration, as a puzzle-pack
+// build makes them, with or without the fixed-size kernels.
+static void benchDifficulty(BenchState &state, Difficulty difficulty, bool fixed)
+{
+    Maze maze;
+    maze.setFixedSizeKernels(fixed);
+    uint64_t seed = MAZE_SEED;
+    while (state.keepRunning())
+    {
+        maze.init(difficulty, seed++);
+    }
+    state.itemsPerIteration = 1;
+}
+
+static void benchSolve(BenchState &state, Size size, SolverKind kind)
+{
+    state.pauseTiming();
+    Maze maze;
+    maze.init(size.rows, size.cols, Generator::DFS, MAZE_SEED);
+    maze.setSolver(kind);
+    vector<pair<int, int>> path;
+    SolveStats stats;
+    state.resumeTiming();
+
+    while (state.keepRunning())
+    {
+        maze.solve(path, stats);
+    }
+    state.itemsPerIteration = double(maze.getRows()) * maze.getCols();
+}
+
+// A fixed random walk of MOVES moves; every iteration continues the same walk.
+static void benchMoves(BenchState &state, Size size)
+{
+    const int MOVES = 4096;
+    const int dx[] = {-1, 1, 0, 0};
+    const int dy[] = {0, 0, -1, 1};
+
+    state.pauseTiming();
+    Maze maze;
+    maze.init(size.rows, size.cols, Generator::DFS, MAZE_SEED);
+    mt19937 gen(MOVE_SEED);
+    vector<uint8_t> dirs(MOVES);
+    for (auto &d : dirs)
+    {
+        d = gen() % 4;
+    }
+    state.resumeTiming();
+
+    while (state.keepRunning())
+    {
+        for (uint8_t d : dirs)
+        {
+            maze.movePlayer(dx[d], dy[d]);
+        }
+    }
+    state.itemsPerIteration = MOVES;
+}
+
+static void benchLayeredGenerate(BenchState &state, Size size, int levels)
+{
+    LayeredMaze maze;
+    while (state.keepRunning())
+    {
+        maze.init(size.rows, size.cols, levels, MAZE_SEED);
+    }
+    state.itemsPerIteration = double(maze.getRows()) * maze.getCols() * levels;
+    state.bytes = double(maze.getBytes());
+}
+
+static void benchLayeredSolve(BenchState &state, Size size, int levels)
+{
+    state.pauseTiming();
+    LayeredMaze maze;
+    maze.init(size.rows, size.cols, levels, MAZE_SEED);
+    long long nodes;
+    state.resumeTiming();
+
+    while (state.keepRunning())
+    {
+        maze.solve(nodes);
+    }
+    state.itemsPerIteration = double(maze.getRows()) * maze.getCols() * levels;
+    state.bytes = double(maze.getBytes());
+}
+
+// The in-grid backtracker on a grid of the given layout.
+template <typename GridType>
+static void benchLayoutGenerate(BenchState &state, Size size)
+{
+    GridType grid;
+    state.countCacheMisses();
+    while (state.keepRunning())
+    {
+        grid.assign(size.rows, size.cols, Grid::KIND_WALL);
+        gridkernels::carveBacktrack(grid, 1, 1, MAZE_SEED);
+    }
+    state.itemsPerIteration = double(size.rows) * size.cols;
+    state.bytes = double(grid.size());
+}
+
+// The exit-rooted BFS distance field of a backtracker maze of the given layout.
+template <typename GridType>
+static void benchLayoutBfs(BenchState &state, Size size)
+{
+    state.pauseTiming();
+    GridType grid;
+    grid.assign(size.rows, size.cols, Grid::KIND_WALL);
+    gridkernels::carveBacktrack(grid, 1, 1, MAZE_SEED);
+    size_t exit = grid.index(size.rows - 2, size.cols - 2);
+    vector<int32_t> distance;
+    vector<size_t> queue;
+    state.countCacheMisses();
+    state.resumeTiming();
+
+    while (state.keepRunning())
+    {
+        gridkernels::distanceField(grid, exit, distance, queue, nullptr);
+    }
+    state.itemsPerIteration = double(size.rows) * size.cols;
+    state.bytes = double(grid.size());
+}
+
+// Keeps the hint lookups from being optimised away.
+static volatile long long hintSink;
+
+// One hint lookup from every cell of a braided maze, with or without the
+// next-hop table.
+static void benchHints(BenchState &state, Size size, bool table)
+{
+    state.pauseTiming();
+    Maze maze;
+    maze.setNextHopTable(table);
+    maze.init(size.rows, size.cols, Generator::DFS, MAZE_SEED, 30);
+    state.resumeTiming();
+
+    long long sum = 0;
+    while (state.keepRunning())
+    {
+        for (int i = 1; i < maze.getRows() - 1; i++)
+        {
+            for (int j = 1; j < maze.getCols() - 1; j++)
+            {
+                sum += maze.getNextHop(i, j).second;
+            }
+        }
+    }
+    state.itemsPerIteration = double(maze.getRows() - 2) * (maze.getCols() - 2);
+    state.bytes = double(maze.getNextHopTableBytes());
+    hintSink = sum;
+}
+
+// Builds one full frame: the view of every cell, as a front end would draw it.
+static void benchRender(BenchState &state, Size size)
+{
+    state.pauseTiming();
+    Maze maze;
+    maze.init(size.rows, size.cols, Generator::DFS, MAZE_SEED);
+    maze.toggleSolution();
+    vector<char> frame(size_t(maze.getRows()) * maze.getCols());
+    state.resumeTiming();
+
+    while (state.keepRunning())
+    {
+        char *out = frame.data();
+        for (int i = 0; i < maze.getRows(); i++)
+        {
+            for (int j = 0; j < maze.getCols(); j++)
+            {
+                *out++ = Maze::glyph(maze.cellView(i, j));
+            }
+        }
+    }
+    state.itemsPerIteration = double(frame.size());
+}
+
+// One move of the fixed walk followed by a complete frame: every cell is drawn
+// into a FrameBuffer and only the changed runs are handed to a no-op writer.
+static void benchFrame(BenchState &state, Size size)
+{
+    const int MOVES = 4096;
+    const int dx[] = {-1, 1, 0, 0};
+    const int dy[] = {0, 0, -1, 1};
+
+    state.pauseTiming();
+    Maze maze;
+    maze.init(size.rows, size.cols, Generator::DFS, MAZE_SEED);
+    mt19937 gen(MOVE_SEED);
+    vector<uint8_t> dirs(MOVES);
+    for (auto &d : dirs)
+    {
+        d = gen() % 4;
+    }
+    FrameBuffer frame;
+    frame.resize(maze.getCols(), maze.getRows());
+    size_t move = 0;
+    state.resumeTiming();
+
+    while (state.keepRunning())
+    {
+        uint8_t d = dirs[move++ % MOVES];
+        maze.movePlayer(dx[d], dy[d]);
+        for (int i = 0; i < maze.getRows(); i++)
+        {
+            for (int j = 0; j < maze.getCols(); j++)
+            {
+                CellView view = maze.cellView(i, j);
+                frame.put(j, i, Maze::glyph(view), Maze::color(view));
+            }
+        }
+        frame.present([](int, int, const char *, int, ConsoleColor) {});
+    }
+    state.itemsPerIteration = double(maze.getRows()) * maze.getCols();
+}
+
+// Leaderboard submissions: every iteration feeds the same SUBMISSIONS random
+// times into an empty board of capacity k.
+static const int SUBMISSIONS = 4096;
+
+static vector<ScoreRecord> scoreSubmissions()
+{
+    mt19937 gen(MOVE_SEED);
+    uniform_real_distribution<double> seconds(5.0, 500.0);
+    vector<ScoreRecord> scores(SUBMISSIONS);
+    for (size_t i = 0; i < scores.size(); i++)
+    {
+        scores[i].seconds = seconds(gen);
+        scores[i].timestamp = static_cast<int64_t>(i);
+    }
+    return scores;
+}
+
+struct FasterScore
+{
+    bool operator()(const ScoreRecord &a, const ScoreRecord &b) const { return a.seconds < b.seconds; }
+};
+
+static void benchTopKInsert(BenchState &state, size_t k)
+{
+    state.pauseTiming();
+    vector<ScoreRecord> scores = scoreSubmissions();
+    TopK<ScoreRecord, FasterScore> board(k);
+    state.resumeTiming();
+
+    while (state.keepRunning())
+    {
+        board.clear();
+        for (const ScoreRecord &score : scores)
+        {
+            board.insert(score);
+        }
+    }
+    state.itemsPerIteration = SUBMISSIONS;
+}
+
+// The old ScoreManager::addHighScore: push_back, full sort, resize.
+static void benchSortInsert(BenchState &state, size_t k)
+{
+    state.pauseTiming();
+    vector<ScoreRecord> scores = scoreSubmissions();
+    vector<ScoreRecord> board;
+    state.resumeTiming();
+
+    while (state.keepRunning())
+    {
+        board.clear();
+        for (const ScoreRecord &score : scores)
+        {
+            if (board.size() < k || score.seconds < board.back().seconds)
+            {
+                board.push_back(score);
+                sort(board.begin(), board.end(), FasterScore());
+                if (board.size() > k)
+                {
+                    board.resize(k);
+                }
+            }
+        }
+    }
+    state.itemsPerIteration = SUBMISSIONS;
+}
+
+// Keeps the rank queries from being optimised away.
+static volatile size_t rankSink;
+
+// "What place would this time be?" against a full board.
+static void benchTopKRank(BenchState &state, size_t k)
+{
+    state.pauseTiming();
+    vector<ScoreRecord> scores = scoreSubmissions();
+    TopK<ScoreRecord, FasterScore> board(k);
+    for (const ScoreRecord &score : scores)
+    {
+        board.insert(score);
+    }
+    size_t sum = 0;
+    state.resumeTiming();
+
+    while (state.keepRunning())
+    {
+        for (const ScoreRecord &score : scores)
+        {
+            sum += board.rank(score);
+        }
+    }
+    state.itemsPerIteration = SUBMISSIONS;
+    rankSink = sum;
+}
+
+static vector<Benchmark> registerBenchmarks(int maxSize)
+{
+    vector<Size> sizes = {{11, 19}, {15, 27}, {21, 39}, {101, 101}, {501, 501},
+                          {1001, 1001}, {2001, 2001}, {4001, 4001}, {8001, 8001}};
+    vector<Benchmark> benchmarks;
+
+    for (const Size &size : sizes)
+    {
+        if (size.rows > maxSize || size.cols > maxSize)
+        {
+            continue;
+        }
+        string suffix = "/" + sizeName(size);
+
+        for (Generator generator : {Generator::DFS, Generator::BACKTRACK, Generator::ELLER, Generator::KRUSKAL,
+                                    Generator::WILSON, Generator::BINARY_TREE, Generator::SIDEWINDER,
+                                    Generator::GROWING_TREE})
+        {
+            benchmarks.push_back({string("generate/") + generatorName(generator) + suffix,
+                                  [size, generator](BenchState &s) { benchGenerate(s, size, generator); }});
+        }
+        for (SolverKind kind : allSolverKinds())
+        {
+            benchmarks.push_back({string("solve/") + solverName(kind) + suffix,
+                                  [size, kind](BenchState &s) { benchSolve(s, size, kind); }});
+        }
+        benchmarks.push_back({"moves" + suffix, [size](BenchState &s) { benchMoves(s, size); }});
+        benchmarks.push_back({"hints/gradient" + suffix, [size](BenchState &s) { benchHints(s, size, false); }});
+        benchmarks.push_back({"hints/table" + suffix, [size](BenchState &s) { benchHints(s, size, true); }});
+        benchmarks.push_back({"render" + suffix, [size](BenchState &s) { benchRender(s, size); }});
+        benchmarks.push_back({"frame" + suffix, [size](BenchState &s) { benchFrame(s, size); }});
+    }
+
+    const pair<Difficulty, const char *> difficulties[] = {
+        {Difficulty::EASY, "easy"}, {Difficulty::MEDIUM, "medium"}, {Difficulty::HARD, "hard"}};
+    for (const auto &[difficulty, name] : difficulties)
+    {
+        Difficulty d = difficulty;
+        benchmarks.push_back({string("difficulty/") + name + "/fixed",
+                              [d](BenchState &s) { benchDifficulty(s, d, true); }});
+        benchmarks.push_back({string("difficulty/") + name + "/dynamic",
+                              [d](BenchState &s) { benchDifficulty(s, d, false); }});
+    }
+
+    struct LayeredSize
+    {
+        Size size;
+        int levels;
+    };
+    for (const LayeredSize &layered : {LayeredSize{{101, 101}, 10}, LayeredSize{{501, 501}, 50}})
+    {
+        if (layered.size.rows > maxSize || layered.size.cols > maxSize)
+        {
+            continue;
+        }
+        string suffix = "/" + sizeName(layered.size) + "x" + to_string(layered.levels);
+        Size size = layered.size;
+        int levels = layered.levels;
+        benchmarks.push_back(
+            {"layered/generate" + suffix, [size, levels](BenchState &s) { benchLayeredGenerate(s, size, levels); }});
+        benchmarks.push_back(
+            {"layered/solve" + suffix, [size, levels](BenchState &s) { benchLayeredSolve(s, size, levels); }});
+    }
+
+    // Grid layouts at sizes that fit in L2, in the last-level cache, and in neither.
+    for (const Size &size : {Size{501, 501}, Size{2001, 2001}, Size{8001, 8001}})
+    {
+        if (size.rows > maxSize || size.cols > maxSize)
+        {
+            continue;
+        }
+        string suffix = "/" + sizeName(size);
+        benchmarks.push_back({"layout/generate/rowmajor" + suffix,
+                              [size](BenchState &s) { benchLayoutGenerate<Grid>(s, size); }});
+        benchmarks.push_back({"layout/generate/tiled" + suffix,
+                              [size](BenchState &s) { benchLayoutGenerate<TiledGrid>(s, size); }});
+        benchmarks.push_back({"layout/generate/morton" + suffix,
+                              [size](BenchState &s) { benchLayoutGenerate<MortonGrid>(s, size); }});
+        benchmarks.push_back({"layout/bfs/rowmajor" + suffix, [size](BenchState &s) { benchLayoutBfs<Grid>(s, size); }});
+        benchmarks.push_back({"layout/bfs/tiled" + suffix,
+                              [size](BenchState &s) { benchLayoutBfs<TiledGrid>(s, size); }});
+        benchmarks.push_back({"layout/bfs/morton" + suffix,
+                              [size](BenchState &s) { benchLayoutBfs<MortonGrid>(s, size); }});
+    }
+
+    for (size_t k : {5, 100, 1000})
+    {
+        string suffix = "/" + to_string(k);
+        benchmarks.push_back({"leaderboard/topk" + suffix, [k](BenchState &s) { benchTopKInsert(s, k); }});
+        benchmarks.push_back({"leaderboard/sort" + suffix, [k](BenchState &s) { benchSortInsert(s, k); }});
+        benchmarks.push_back({"leaderboard/rank" + suffix, [k](BenchState &s) { benchTopKRank(s, k); }});
+    }
+    return benchmarks;
+}
+
+static Result runBenchmark(const Benchmark &benchmark, double minTime)
+{
+    long long iterations = 1;
+    while (true)
+    {
+        BenchState state(iterations);
+        benchmark.body(state);
+        double seconds = state.seconds();
+
+        if (seconds >= minTime || iterations >= 1000000000LL)
+        {
+            Result result;
+            result.name = benchmark.name;
+            result.iterations = iterations;
+            result.nsPerIteration = seconds * 1e9 / iterations;
+            result.itemsPerSecond = seconds > 0 ? state.itemsPerIteration * iterations / seconds : 0.0;
+            result.bytes = state.bytes;
+            long long misses = state.cacheMisses();
+            result.missesPerIteration = misses >= 0 ? double(misses) / iterations : -1.0;
+            return result;
+        }
+
+        // Aim slightly past minTime next round, growing at most tenfold at once.
+        double scale = seconds > 0 ? minTime * 1.4 / seconds : 10.0;
+        iterations = max(iterations + 1, static_cast<long long>(iterations * min(scale, 10.0)));
+    }
+}
+
+static string timestamp()
+{
+    time_t now = system_clock::to_time_t(system_clock::now());
+    char buffer[32];
+    strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    return buffer;
+}
+
+static void writeJson(ostream &out, const vector<Result> &results)
+{
+    out << "{\n"
+        << "  \"context\": {\n"
+        << "    \"date\": \"" << timestamp() << "\",\n"
+        << "    \"maze_seed\": " << MAZE_SEED << ",\n"
+        << "    \"move_seed\": " << MOVE_SEED << "\n"
+        << "  },\n"
+        << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result &r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+            << ", \"real_time\": " << fixed << setprecision(1) << r.nsPerIteration
+            << ", \"time_unit\": \"ns\", \"items_per_second\": " << setprecision(0) << r.itemsPerSecond;
+        if (r.bytes > 0)
+        {
+            out << ", \"bytes\": " << r.bytes;
+        }
+        if (r.missesPerIteration >= 0)
+        {
+            out << ", \"cache_misses\": " << r.missesPerIteration;
+        }
+        out << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+static void writeCsv(ostream &out, const vector<Result> &results)
+{
+    out << "name,iterations,real_time_ns,items_per_second,bytes,cache_misses\n";
+    for (const Result &r : results)
+    {
+        out << r.name << "," << r.iterations << "," << fixed << setprecision(1) << r.nsPerIteration << ","
+            << setprecision(0) << r.itemsPerSecond << "," << r.bytes << ",";
+        if (r.missesPerIteration >= 0)
+        {
+            out << r.missesPerIteration;
+        }
+        out << "\n";
+    }
+}
+
+static void printUsage(const char *argv0)
+{
+    cout << "Usage: " << argv0 << " [options]\n"
+         << "  --filter TEXT               only run benchmarks whose name contains TEXT\n"
+         << "  --max-size N                skip mazes with a side longer than N (default 8001)\n"
+         << "  --min-time SECONDS          minimum timed duration per benchmark (default 0.5)\n"
+         << "  --format console|json|csv   output format (default console)\n"
+         << "  --out FILE                  write json/csv output to FILE instead of stdout\n";
+}
+
+int main(int argc, char **argv)
+{
+    string filter;
+    string format = "console";
+    string outPath;
+    int maxSize = 8001;
+    double minTime = 0.5;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--filter" && hasValue)
+            filter = argv[++i];
+        else if (arg == "--max-size" && hasValue)
+            maxSize = atoi(argv[++i]);
+        else if (arg == "--min-time" && hasValue)
+            minTime = atof(argv[++i]);
+        else if (arg == "--format" && hasValue)
+            format = argv[++i];
+        else if (arg == "--out" && hasValue)
+            outPath = argv[++i];
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (format != "console" && format != "json" && format != "csv")
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    vector<Result> results;
+    for (const Benchmark &benchmark : registerBenchmarks(maxSize))
+    {
+        if (!filter.empty() && benchmark.name.find(filter) == string::npos)
+        {
+            continue;
+        }
+        Result result = runBenchmark(benchmark, minTime);
+        results.push_back(result);
+
+        // Progress goes to stderr so machine-readable output stays clean.
+        ostream &progress = format == "console" ? cout : cerr;
+        progress << left << setw(36) << result.name << right << setw(12) << result.iterations
+                 << setw(18) << fixed << setprecision(1) << result.nsPerIteration << " ns"
+                 << setw(16) << setprecision(3) << result.itemsPerSecond / 1e6 << " M items/s";
+        if (result.bytes > 0)
+        {
+            progress << setw(12) << setprecision(1) << result.bytes / 1024.0 << " KiB";
+        }
+        if (result.missesPerIteration >= 0)
+        {
+            progress << setw(14) << setprecision(0) << result.missesPerIteration << " misses";
+        }
+        progress << "\n";
+    }
+
+    if (format == "console")
+    {
+        return 0;
+    }
+
+    ofstream file;
+    if (!outPath.empty())
+    {
+        file.open(outPath);
+        if (!file.good())
+        {
+            cerr << "cannot write " << outPath << "\n";
+            return 1;
+        }
+    }
+    ostream &out = outPath.empty() ? cout : file;
+    if (format == "json")
+        writeJson(out, results);
+    else
+        writeCsv(out, results);
+    return 0;
+}
@@ -0,0 +1,58 @@
+# Replays input logs whose last session was cut short by a crash.
+#   cmake -DHEADLESS=path/to/mazeHeadless -DWORK_DIR=dir -P ReplayCheck.cmake
+# A log whose last session lost its end marker, followed by more sessions
+# (read back as they are, and appended to through --record), must replay to
+# the same sessions and digest as the intact log. So must the intact log with
+# a session cut inside its 24-byte header in between.
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+function(run)
+    execute_process(COMMAND ${ARGN} WORKING_DIRECTORY "${WORK_DIR}" RESULT_VARIABLE result OUTPUT_QUIET)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "failed (${result}): ${ARGN}")
+    endif()
+endfunction()
+
+function(record file seed)
+    run("${HEADLESS}" --difficulty easy --seed ${seed} --repeat 3 --random-moves 40 --record ${file})
+endfunction()
+
+function(replay file outSummary)
+    execute_process(COMMAND "${HEADLESS}" --replay ${file} WORKING_DIRECTORY "${WORK_DIR}"
+                    RESULT_VARIABLE result OUTPUT_VARIABLE output)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "replay of ${file} failed (${result})")
+    endif()
+    string(REGEX MATCH "sessions: [0-9]+" sessions "${output}")
+    string(REGEX MATCH "digest: +[0-9a-f]+" digest "${output}")
+    set(${outSummary} "${sessions}, ${digest}" PARENT_SCOPE)
+endfunction()
+
+record(first.mzi 1)
+record(second.mzi 100)
+run(sh -c "cat first.mzi second.mzi > intact.mzi")
+file(SIZE "${WORK_DIR}/first.mzi" size)
+math(EXPR tornSize "${size} - 1")
+run(sh -c "head -c ${tornSize} first.mzi > torn-first.mzi")
+run(sh -c "cat torn-first.mzi second.mzi > torn.mzi")
+run(sh -c "cp torn-first.mzi appended.mzi")
+record(appended.mzi 100)
+record(third.mzi 200)
+foreach(headerBytes 4 12 23)
+    run(sh -c "head -c ${headerBytes} third.mzi > torn-header.mzi")
+    run(sh -c "cat first.mzi torn-header.mzi second.mzi > torn-header-${headerBytes}.mzi")
+endforeach()
+
+replay(intact.mzi expected)
+if(NOT expected MATCHES "^sessions: 6, ")
+    message(FATAL_ERROR "intact log: ${expected}")
+endif()
+foreach(log torn.mzi appended.mzi torn-header-4.mzi torn-header-12.mzi torn-header-23.mzi)
+    replay(${log} actual)
+    if(NOT actual STREQUAL expected)
+        message(FATAL_ERROR "${log}: ${actual}, expected ${expected}")
+    endif()
+endforeach()
+message(STATUS "${expected}")
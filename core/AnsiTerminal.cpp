@@ -0,0 +1,220 @@
+#include "AnsiTerminal.h"
+
+#include <cerrno>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+
+// Console colours are IRGB (blue is bit 0); ANSI colours are RGB with red in bit 0.
+const int ANSI_COLOR[] = {0, 4, 2, 6, 1, 5, 3, 7};
+
+long writeSome(int fd, const char *data, size_t length)
+{
+#ifdef _WIN32
+    return _write(fd, data, static_cast<unsigned int>(length));
+#else
+    return static_cast<long>(::write(fd, data, length));
+#endif
+}
+
+// Blocks until a non-blocking fd can take more output. Returns false if it
+// never will (an error or hangup on the fd).
+bool waitWritable(int fd)
+{
+#ifdef _WIN32
+    (void)fd;
+    return true;
+#else
+    pollfd request = {fd, POLLOUT, 0};
+    while (poll(&request, 1, -1) < 0)
+    {
+        if (errno != EINTR)
+        {
+            return false;
+        }
+    }
+    return (request.revents & (POLLERR | POLLHUP | POLLNVAL)) == 0;
+#endif
+}
+
+} // namespace
+
+AnsiTerminal::AnsiTerminal(int fd, size_t capacity)
+    : fd(fd), textColor(ConsoleColor::LIGHTGRAY), bgColor(ConsoleColor::BLACK), colorKnown(false),
+      cursorX(-1), cursorY(-1), writeCalls(0), bytesWritten(0)
+{
+    buffer.reserve(capacity);
+}
+
+AnsiTerminal::~AnsiTerminal()
+{
+    flush();
+}
+
+void AnsiTerminal::appendNumber(int n)
+{
+    char digits[12];
+    int count = 0;
+    unsigned value = n < 0 ? 0u : static_cast<unsigned>(n);
+    do
+    {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (count > 0)
+    {
+        buffer += digits[--count];
+    }
+}
+
+void AnsiTerminal::append(const char *text, size_t length)
+{
+    buffer.append(text, length);
+}
+
+void AnsiTerminal::setColor(ConsoleColor text, ConsoleColor bg)
+{
+    if (colorKnown && text == textColor && bg == bgColor)
+    {
+        return;
+    }
+    int fg = static_cast<int>(text);
+    int back = static_cast<int>(bg);
+
+    // ESC[<fg>;<bg>m, with the 9x/10x codes for the bright half of the palette.
+    append("\x1b[", 2);
+    appendNumber((fg & 8 ? 90 : 30) + ANSI_COLOR[fg & 7]);
+    buffer += ';';
+    appendNumber((back & 8 ? 100 : 40) + ANSI_COLOR[back & 7]);
+    buffer += 'm';
+
+    textColor = text;
+    bgColor = bg;
+    colorKnown = true;
+}
+
+void AnsiTerminal::resetColor()
+{
+    setColor(ConsoleColor::LIGHTGRAY);
+}
+
+void AnsiTerminal::gotoXY(int x, int y)
+{
+    if (x == cursorX && y == cursorY)
+    {
+        return;
+    }
+    append("\x1b[", 2);
+    appendNumber(y + 1);
+    buffer += ';';
+    appendNumber(x + 1);
+    buffer += 'H';
+    cursorX = x;
+    cursorY = y;
+}
+
+void AnsiTerminal::print(const string &text)
+{
+    print(text.data(), text.size());
+}
+
+void AnsiTerminal::print(const char *text, size_t length)
+{
+    append(text, length);
+    if (cursorX >= 0)
+    {
+        cursorX += static_cast<int>(length);
+    }
+}
+
+void AnsiTerminal::write(int x, int y, const char *text, int length, ConsoleColor color)
+{
+    gotoXY(x, y);
+    setColor(color);
+    print(text, static_cast<size_t>(length));
+}
+
+void AnsiTerminal::drawBox(int left, int top, int width, int height, ConsoleColor bg)
+{
+    // The Win32 version uses the CP437 full block; ANSI terminals speak UTF-8,
+    // so the border is drawn as reverse-video spaces instead.
+    string edge(width, ' ');
+    setColor(ConsoleColor::BLACK, ConsoleColor::WHITE);
+    gotoXY(left, top);
+    print(edge);
+
+    for (int i = 1; i < height - 1; i++)
+    {
+        setColor(ConsoleColor::BLACK, ConsoleColor::WHITE);
+        gotoXY(left, top + i);
+        print(" ", 1);
+        setColor(ConsoleColor::WHITE, bg);
+        print(string(width - 2, ' '));
+        setColor(ConsoleColor::BLACK, ConsoleColor::WHITE);
+        print(" ", 1);
+    }
+
+    setColor(ConsoleColor::BLACK, ConsoleColor::WHITE);
+    gotoXY(left, top + height - 1);
+    print(edge);
+    resetColor();
+}
+
+void AnsiTerminal::clearScreen()
+{
+    resetColor();
+    append("\x1b[2J\x1b[H", 7);
+    cursorX = 0;
+    cursorY = 0;
+}
+
+void AnsiTerminal::showCursor(bool visible)
+{
+    append(visible ? "\x1b[?25h" : "\x1b[?25l", 6);
+}
+
+void AnsiTerminal::useAlternateScreen(bool enabled)
+{
+    append(enabled ? "\x1b[?1049h" : "\x1b[?1049l", 8);
+    cursorX = -1;
+    cursorY = -1;
+    colorKnown = false;
+}
+
+bool AnsiTerminal::flush()
+{
+    size_t done = 0;
+    while (done < buffer.size())
+    {
+        long n = writeSome(fd, buffer.data() + done, buffer.size() - done);
+        writeCalls++;
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            // A non-blocking terminal is full: wait for room instead of
+            // spinning on write().
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && waitWritable(fd))
+            {
+                continue;
+            }
+            buffer.clear();
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    bytesWritten += static_cast<long long>(done);
+    buffer.clear();
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef MAZE_ANSI_TERMINAL_H
+#define MAZE_ANSI_TERMINAL_H
+
+#include <cstddef>
+#include <string>
+
+#include "FrameBuffer.h"
+
+// Terminal output through ANSI escape sequences, for xterm-compatible
+// terminals (Linux, macOS, Windows 10+ consoles, anything over SSH). Offers the
+// same drawing operations as the Win32 Console in mazeRunner.cpp, but nothing
+// reaches the terminal until flush(): every operation only appends to one
+// preallocated byte buffer, and flush() hands the whole frame to the kernel in
+// a single write() call.
+//
+// The terminal's colour and cursor position are tracked, so redundant colour
+// changes and cursor moves (say, between two adjacent runs from
+// FrameBuffer::present) are never emitted.
+class AnsiTerminal
+{
+private:
+    int fd;
+    std::string buffer;
+    ConsoleColor textColor, bgColor;
+    bool colorKnown;
+    int cursorX, cursorY;
+    long long writeCalls;
+    long long bytesWritten;
+
+    void appendNumber(int n);
+    void append(const char *text, size_t length);
+
+public:
+    // Writes to the given file descriptor (stdout by default).
+    explicit AnsiTerminal(int fd = 1, size_t capacity = 1 << 16);
+    ~AnsiTerminal();
+
+    AnsiTerminal(const AnsiTerminal &) = delete;
+    AnsiTerminal &operator=(const AnsiTerminal &) = delete;
+
+    void setColor(ConsoleColor text, ConsoleColor bg = ConsoleColor::BLACK);
+    void resetColor();
+    void gotoXY(int x, int y);
+    void print(const std::string &text);
+    void print(const char *text, size_t length);
+    // Writes one run of same-coloured text, as handed out by FrameBuffer::present.
+    void write(int x, int y, const char *text, int length, ConsoleColor color);
+    void drawBox(int left, int top, int width, int height, ConsoleColor bg = ConsoleColor::BLACK);
+    void clearScreen();
+    void showCursor(bool visible);
+    // Switches to (or back from) the alternate screen, which keeps the shell's
+    // scrollback intact while a full-screen program runs.
+    void useAlternateScreen(bool enabled);
+
+    // Sends everything buffered so far with one write() (more only if the
+    // kernel accepts a partial write; on a non-blocking fd that is full it
+    // polls for room first). Returns false on an I/O error.
+    bool flush();
+
+    size_t pending() const { return buffer.size(); }
+    long long getWriteCalls() const { return writeCalls; }
+    long long getBytesWritten() const { return bytesWritten; }
+};
+
+#endif
@@ -0,0 +1,168 @@
+#include "BitGrid.h"
+
+#include <algorithm>
+
+#include "BitKernels.h"
+
+using namespace std;
+
+// Switch to full row sweeps once this fraction of all words is in the frontier.
+static const size_t DENSE_FRACTION = 16;
+
+void BitGrid::assign(int newRows, int newCols)
+{
+    rows = newRows;
+    cols = newCols;
+    rowWords = paddedRowWords(cols);
+    words.assign(static_cast<size_t>(rows) * rowWords, 0);
+}
+
+void BitGrid::fromGrid(const Grid &grid)
+{
+    assign(grid.getRows(), grid.getCols());
+
+    // Grid rows are padded to a multiple of 64 cells with walls, so each one
+    // packs into whole words.
+    for (int r = 0; r < rows; r++)
+    {
+        bitkernels::packOpen(grid.data() + grid.index(r, 0), grid.getStride(), row(r));
+    }
+}
+
+bool BitBfs::solve(const BitGridView &grid, pair<int, int> from, pair<int, int> to, vector<pair<int, int>> &path,
+                   long long &visited)
+{
+    path.clear();
+    visited = 0;
+    if (!grid.isOpen(from.first, from.second) || !grid.isOpen(to.first, to.second))
+    {
+        return false;
+    }
+
+    size_t words = grid.wordCount();
+    size_t rowWords = grid.rowWords;
+    plane0.assign(words, 0);
+    plane1.assign(words, 0);
+    frontier.assign(words, 0);
+    next.assign(words, 0);
+    active.clear();
+    pending.clear();
+
+    size_t sourceWord = from.first * rowWords + (from.second >> 6);
+    size_t targetWord = to.first * rowWords + (to.second >> 6);
+    uint64_t targetBit = uint64_t(1) << (to.second & 63);
+
+    // Level l is stored as l % 3 + 1, split over the two planes.
+    frontier[sourceWord] = uint64_t(1) << (from.second & 63);
+    plane0[sourceWord] = frontier[sourceWord];
+    active.push_back(sourceWord);
+    visited = 1;
+
+    int level = 0;
+    bool dense = false;
+    size_t denseFirst = rowWords;
+    size_t denseLast = words - rowWords;
+
+    while (!((plane0[targetWord] | plane1[targetWord]) & targetBit))
+    {
+        int code = (level + 1) % 3 + 1;
+        uint64_t mask0 = code & 1 ? ~uint64_t(0) : 0;
+        uint64_t mask1 = code & 2 ? ~uint64_t(0) : 0;
+        long long found = 0;
+
+        if (!dense && active.size() > words / DENSE_FRACTION)
+        {
+            dense = true;
+        }
+
+        if (dense)
+        {
+            bitkernels::DenseLevel step = {frontier.data(), grid.words, plane0.data(), plane1.data(),
+                                           next.data(), static_cast<ptrdiff_t>(rowWords), mask0, mask1};
+            found = bitkernels::expandDense(step, denseFirst, denseLast);
+            frontier.swap(next);
+
+            if (static_cast<size_t>(found) < words / DENSE_FRACTION)
+            {
+                // Back to sparse: rebuild the active list, and `next` must be all zero.
+                dense = false;
+                fill(next.begin(), next.end(), 0);
+                active.clear();
+                for (size_t w = denseFirst; w < denseLast; w++)
+                {
+                    if (frontier[w])
+                    {
+                        active.push_back(w);
+                    }
+                }
+            }
+        }
+        else
+        {
+            // The outer ring is wall, so frontier words never sit in the first
+            // or last row and all four neighbouring words exist.
+            pending.clear();
+            for (size_t w : active)
+            {
+                uint64_t f = frontier[w];
+                frontier[w] = 0;
+                spread(w, (f << 1) | (f >> 1));
+                spread(w - 1, f << 63);
+                spread(w + 1, f >> 63);
+                spread(w - rowWords, f);
+                spread(w + rowWords, f);
+            }
+
+            active.clear();
+            for (size_t w : pending)
+            {
+                uint64_t fresh = next[w] & grid.words[w] & ~(plane0[w] | plane1[w]);
+                next[w] = 0;
+                if (fresh)
+                {
+                    frontier[w] = fresh;
+                    plane0[w] |= fresh & mask0;
+                    plane1[w] |= fresh & mask1;
+                    active.push_back(w);
+                    found += bitkernels::popcount(fresh);
+                }
+            }
+        }
+
+        if (found == 0)
+        {
+            return false;
+        }
+        visited += found;
+        level++;
+    }
+
+    // Walk back from the target, always to a neighbour one level closer.
+    static const int DR[] = {-1, 1, 0, 0};
+    static const int DC[] = {0, 0, -1, 1};
+    path.resize(level + 1);
+    pair<int, int> current = to;
+    path[level] = current;
+    for (int l = level; l > 0; l--)
+    {
+        int want = (l - 1) % 3 + 1;
+        for (int dir = 0; dir < 4; dir++)
+        {
+            int r = current.first + DR[dir];
+            int c = current.second + DC[dir];
+            if (levelCode(r * rowWords + (c >> 6), c & 63) == want)
+            {
+                current = {r, c};
+                break;
+            }
+        }
+        path[l - 1] = current;
+    }
+    return true;
+}
+
+size_t BitBfs::scratchBytes() const
+{
+    size_t words = plane0.capacity() + plane1.capacity() + frontier.capacity() + next.capacity();
+    return words * sizeof(uint64_t) + (active.capacity() + pending.capacity()) * sizeof(size_t);
+}
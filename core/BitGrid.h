@@ -0,0 +1,106 @@
+#ifndef MAZE_BIT_GRID_H
+#define MAZE_BIT_GRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Grid.h"
+
+// Read-only view of a maze stored as one bit per cell: bit (col % 64) of word
+// (row * rowWords + col / 64) is set when the cell is open. This is the row
+// format EllerGenerator emits, so streamed and packed mazes can be viewed in
+// place; rowWords may be larger than needed to pad rows. As with Grid, the
+// outer ring must be wall.
+struct BitGridView
+{
+    const uint64_t *words = nullptr;
+    int rows = 0;
+    int cols = 0;
+    size_t rowWords = 0;
+
+    size_t wordCount() const { return static_cast<size_t>(rows) * rowWords; }
+
+    bool isOpen(int row, int col) const
+    {
+        return words[static_cast<size_t>(row) * rowWords + (col >> 6)] >> (col & 63) & 1;
+    }
+};
+
+// Owning bit-per-cell maze storage, an eighth of the size of a Grid. Rows are
+// padded to whole 256-bit blocks for the AVX2 kernels.
+class BitGrid
+{
+private:
+    int rows, cols;
+    size_t rowWords;
+    std::vector<uint64_t> words;
+
+public:
+    BitGrid() : rows(0), cols(0), rowWords(0) {}
+
+    static size_t paddedRowWords(int cols) { return ((static_cast<size_t>(cols) + 63) / 64 + 3) / 4 * 4; }
+
+    // Resizes to rows x cols with every cell wall.
+    void assign(int newRows, int newCols);
+    // Copies the open cells (anything that is not wall) of grid.
+    void fromGrid(const Grid &grid);
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    size_t getRowWords() const { return rowWords; }
+    size_t bytes() const { return words.size() * sizeof(uint64_t); }
+
+    uint64_t *row(int r) { return words.data() + static_cast<size_t>(r) * rowWords; }
+    bool isOpen(int row, int col) const { return view().isOpen(row, col); }
+    void setOpen(int row, int col) { words[static_cast<size_t>(row) * rowWords + (col >> 6)] |= uint64_t(1) << (col & 63); }
+
+    BitGridView view() const { return {words.data(), rows, cols, rowWords}; }
+};
+
+// Breadth-first search that works on whole 64-bit words of a BitGridView. The
+// frontier is a bitmap; a level spreads every frontier word to itself and its
+// four neighbouring words with shifts and ORs, masked by the open cells and
+// the cells already visited. Narrow frontiers (the usual case in a perfect
+// maze) are expanded sparsely from a list of active words; once the frontier
+// covers a good part of the grid whole rows are swept with bitkernels instead.
+//
+// Instead of a 32-bit distance per cell it keeps the level modulo 3 in two bit
+// planes (0 = unvisited). Neighbours in a BFS differ by at most one level, so
+// that is enough to walk back from the target along a shortest path.
+class BitBfs
+{
+private:
+    std::vector<uint64_t> plane0, plane1;
+    std::vector<uint64_t> frontier, next;
+    std::vector<size_t> active, pending;
+
+    void spread(size_t word, uint64_t bits)
+    {
+        if (bits)
+        {
+            if (!next[word])
+            {
+                pending.push_back(word);
+            }
+            next[word] |= bits;
+        }
+    }
+
+    int levelCode(size_t word, int bit) const
+    {
+        return static_cast<int>((plane0[word] >> bit & 1) | (plane1[word] >> bit & 1) << 1);
+    }
+
+public:
+    // Shortest path between two open cells; on success path holds the cells
+    // from `from` to `to`, both included. visited receives the cells reached.
+    bool solve(const BitGridView &grid, std::pair<int, int> from, std::pair<int, int> to,
+               std::vector<std::pair<int, int>> &path, long long &visited);
+
+    // Memory held between searches, in bytes.
+    size_t scratchBytes() const;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include "BitKernels.h"
+
+namespace bitkernels
+{
+
+void packOpenScalar(const uint8_t *cells, size_t n, uint64_t *words)
+{
+    for (size_t i = 0; i < n; i += 64)
+    {
+        uint64_t bits = 0;
+        for (int b = 0; b < 64; b++)
+        {
+            bits |= uint64_t((cells[i + b] & 0x03) != 0) << b;
+        }
+        words[i / 64] = bits;
+    }
+}
+
+long long expandDenseScalar(const DenseLevel &level, size_t first, size_t last)
+{
+    const uint64_t *f = level.frontier;
+    ptrdiff_t r = level.rowWords;
+    long long found = 0;
+    for (size_t w = first; w < last; w++)
+    {
+        uint64_t reach = (f[w] << 1) | (f[w - 1] >> 63) | (f[w] >> 1) | (f[w + 1] << 63) | f[w - r] | f[w + r];
+        uint64_t fresh = reach & level.open[w] & ~(level.plane0[w] | level.plane1[w]);
+        level.next[w] = fresh;
+        level.plane0[w] |= fresh & level.mask0;
+        level.plane1[w] |= fresh & level.mask1;
+        found += popcount(fresh);
+    }
+    return found;
+}
+
+#ifdef MAZE_HAVE_AVX2
+
+namespace
+{
+
+bool detectAvx2()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+const bool HAVE_AVX2 = detectAvx2();
+
+} // namespace
+
+bool usingAvx2()
+{
+    return HAVE_AVX2;
+}
+
+void packOpen(const uint8_t *cells, size_t n, uint64_t *words)
+{
+    HAVE_AVX2 ? packOpenAvx2(cells, n, words) : packOpenScalar(cells, n, words);
+}
+
+long long expandDense(const DenseLevel &level, size_t first, size_t last)
+{
+    return HAVE_AVX2 ? expandDenseAvx2(level, first, last) : expandDenseScalar(level, first, last);
+}
+
+#else
+
+bool usingAvx2()
+{
+    return false;
+}
+
+void packOpen(const uint8_t *cells, size_t n, uint64_t *words)
+{
+    packOpenScalar(cells, n, words);
+}
+
+long long expandDense(const DenseLevel &level, size_t first, size_t last)
+{
+    return expandDenseScalar(level, first, last);
+}
+
+#endif
+
+} // namespace bitkernels
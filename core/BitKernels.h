@@ -0,0 +1,78 @@
+#ifndef MAZE_BIT_KERNELS_H
+#define MAZE_BIT_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Word-parallel inner loops for BitGrid and BitBfs. Each has a portable scalar
+// version; when the build enables MAZE_HAVE_AVX2 an AVX2 version is compiled
+// into its own translation unit and chosen at run time if the CPU has it.
+namespace bitkernels
+{
+
+// One dense BFS level. For every word w in [first, last) the cells reachable
+// in one step from the frontier are computed from the words at w - 1, w, w + 1,
+// w - rowWords and w + rowWords, so the range must not touch the first or last
+// row. New cells (open and not yet visited) go to next[w] and are added to the
+// two level planes: plane0 where mask0 is all ones, plane1 where mask1 is.
+struct DenseLevel
+{
+    const uint64_t *frontier;
+    const uint64_t *open;
+    uint64_t *plane0;
+    uint64_t *plane1;
+    uint64_t *next;
+    ptrdiff_t rowWords;
+    uint64_t mask0;
+    uint64_t mask1;
+};
+
+// Packs n cell bytes (n a multiple of 64) into n / 64 words; a bit is set when
+// the low two bits of the byte (the Grid cell kind) are not zero, i.e. not wall.
+void packOpen(const uint8_t *cells, size_t n, uint64_t *words);
+
+// Returns the number of new cells.
+long long expandDense(const DenseLevel &level, size_t first, size_t last);
+
+bool usingAvx2();
+
+void packOpenScalar(const uint8_t *cells, size_t n, uint64_t *words);
+long long expandDenseScalar(const DenseLevel &level, size_t first, size_t last);
+
+#ifdef MAZE_HAVE_AVX2
+void packOpenAvx2(const uint8_t *cells, size_t n, uint64_t *words);
+long long expandDenseAvx2(const DenseLevel &level, size_t first, size_t last);
+#endif
+
+inline int popcount(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    int n = 0;
+    for (; x; x &= x - 1)
+    {
+        n++;
+    }
+    return n;
+#endif
+}
+
+inline int lowestBit(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1))
+    {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+} // namespace bitkernels
+
+#endif
@@ -0,0 +1,73 @@
+// AVX2 versions of the bit kernels. This file is compiled with -mavx2 -mpopcnt
+// and only called after a run-time CPU check, see BitKernels.cpp. It sticks to
+// intrinsics so that no inline function from a header gets instantiated with
+// those flags and then shared with the portable code.
+
+#include "BitKernels.h"
+
+#include <immintrin.h>
+
+namespace bitkernels
+{
+
+void packOpenAvx2(const uint8_t *cells, size_t n, uint64_t *words)
+{
+    const __m256i kindMask = _mm256_set1_epi8(0x03);
+    const __m256i zero = _mm256_setzero_si256();
+    for (size_t i = 0; i < n; i += 64)
+    {
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cells + i));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cells + i + 32));
+        uint32_t wallLo = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(lo, kindMask), zero)));
+        uint32_t wallHi = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(hi, kindMask), zero)));
+        words[i / 64] = ~(uint64_t(wallHi) << 32 | wallLo);
+    }
+}
+
+long long expandDenseAvx2(const DenseLevel &level, size_t first, size_t last)
+{
+    const uint64_t *f = level.frontier;
+    ptrdiff_t r = level.rowWords;
+    const __m256i mask0 = _mm256_set1_epi64x(static_cast<long long>(level.mask0));
+    const __m256i mask1 = _mm256_set1_epi64x(static_cast<long long>(level.mask1));
+    long long found = 0;
+
+    size_t w = first;
+    for (; w + 4 <= last; w += 4)
+    {
+        // Unaligned loads one word to either side give every lane its left and
+        // right neighbour word, so the cross-word carries need no shuffles.
+        __m256i mid = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(f + w));
+        __m256i before = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(f + w - 1));
+        __m256i after = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(f + w + 1));
+        __m256i up = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(f + w - r));
+        __m256i down = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(f + w + r));
+
+        __m256i reach = _mm256_or_si256(_mm256_slli_epi64(mid, 1), _mm256_srli_epi64(before, 63));
+        reach = _mm256_or_si256(reach, _mm256_or_si256(_mm256_srli_epi64(mid, 1), _mm256_slli_epi64(after, 63)));
+        reach = _mm256_or_si256(reach, _mm256_or_si256(up, down));
+
+        __m256i *p0 = reinterpret_cast<__m256i *>(level.plane0 + w);
+        __m256i *p1 = reinterpret_cast<__m256i *>(level.plane1 + w);
+        __m256i plane0 = _mm256_loadu_si256(p0);
+        __m256i plane1 = _mm256_loadu_si256(p1);
+        __m256i open = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(level.open + w));
+        __m256i fresh = _mm256_andnot_si256(_mm256_or_si256(plane0, plane1), _mm256_and_si256(reach, open));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(level.next + w), fresh);
+        if (_mm256_testz_si256(fresh, fresh))
+        {
+            continue;
+        }
+        _mm256_storeu_si256(p0, _mm256_or_si256(plane0, _mm256_and_si256(fresh, mask0)));
+        _mm256_storeu_si256(p1, _mm256_or_si256(plane1, _mm256_and_si256(fresh, mask1)));
+
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), fresh);
+        found += _mm_popcnt_u64(lanes[0]) + _mm_popcnt_u64(lanes[1]) + _mm_popcnt_u64(lanes[2]) +
+                 _mm_popcnt_u64(lanes[3]);
+    }
+    return found + expandDenseScalar(level, w, last);
+}
+
+} // namespace bitkernels
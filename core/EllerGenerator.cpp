@@ -0,0 +1,190 @@
+#include "EllerGenerator.h"
+
+#include <algorithm>
+
+using namespace std;
+
+EllerGenerator::EllerGenerator(int rows, int cols, uint64_t seed) : gen(seed)
+{
+    reset(rows, cols, seed);
+}
+
+void EllerGenerator::reset(int newRows, int newCols, uint64_t seed)
+{
+    rows = newRows;
+    cols = newCols;
+    cellCols = (cols - 1) / 2;
+    nextGridRow = 0;
+    gen = Xoshiro256(seed);
+    randomBits = 0;
+    randomBitsLeft = 0;
+
+    parent.resize(cellCols);
+    nextParent.assign(cellCols, 0);
+    rootOf.assign(cellCols, 0);
+    downCount.assign(cellCols, 0);
+    memberCount.assign(cellCols, 0);
+    candidate.assign(cellCols, 0);
+    goesDown.assign(cellCols, 0);
+    for (int j = 0; j < cellCols; j++)
+    {
+        parent[j] = j;
+    }
+}
+
+size_t EllerGenerator::scratchBytes() const
+{
+    return (parent.capacity() + nextParent.capacity() + rootOf.capacity() + downCount.capacity() +
+            memberCount.capacity() + candidate.capacity()) * sizeof(int) + goesDown.capacity();
+}
+
+int EllerGenerator::find(int col)
+{
+    int root = col;
+    while (parent[root] != root)
+    {
+        root = parent[root];
+    }
+    while (parent[col] != root)
+    {
+        int next = parent[col];
+        parent[col] = root;
+        col = next;
+    }
+    return root;
+}
+
+bool EllerGenerator::randomBit()
+{
+    if (randomBitsLeft == 0)
+    {
+        randomBits = gen();
+        randomBitsLeft = 64;
+    }
+    bool bit = randomBits & 1;
+    randomBits >>= 1;
+    randomBitsLeft--;
+    return bit;
+}
+
+static inline void openCell(uint64_t *words, int col)
+{
+    words[col >> 6] |= uint64_t(1) << (col & 63);
+}
+
+void EllerGenerator::emitCellRow(uint64_t *words, bool lastRow)
+{
+    for (int j = 0; j < cellCols; j++)
+    {
+        openCell(words, 2 * j + 1);
+    }
+
+    // Join horizontally adjacent cells that belong to different sets. On the
+    // last row every remaining pair of sets has to be joined.
+    for (int j = 0; j + 1 < cellCols; j++)
+    {
+        int a = find(j);
+        int b = find(j + 1);
+        if (a != b && (lastRow || randomBit()))
+        {
+            parent[b] = a;
+            openCell(words, 2 * j + 2);
+        }
+    }
+
+    if (lastRow)
+    {
+        return;
+    }
+
+    // Pick the downward links for the next row. Every set needs at least one, so
+    // a random member (reservoir-sampled) is forced down when none was chosen.
+    for (int j = 0; j < cellCols; j++)
+    {
+        int root = find(j);
+        rootOf[j] = root;
+        downCount[root] = 0;
+        memberCount[root] = 0;
+    }
+
+    for (int j = 0; j < cellCols; j++)
+    {
+        int root = rootOf[j];
+        memberCount[root]++;
+        if (gen.below(memberCount[root]) == 0)
+        {
+            candidate[root] = j;
+        }
+        goesDown[j] = randomBit();
+        downCount[root] += goesDown[j];
+    }
+
+    for (int j = 0; j < cellCols; j++)
+    {
+        int root = rootOf[j];
+        if (downCount[root] == 0)
+        {
+            goesDown[candidate[root]] = 1;
+            downCount[root] = 1;
+        }
+        // memberCount is reused below to remember the first column linked down.
+        memberCount[root] = -1;
+    }
+
+    // Carry the sets into the next row: cells linked downwards keep their set
+    // (represented by the first such column), all other cells start fresh.
+    for (int j = 0; j < cellCols; j++)
+    {
+        if (goesDown[j])
+        {
+            int root = rootOf[j];
+            if (memberCount[root] < 0)
+            {
+                memberCount[root] = j;
+            }
+            nextParent[j] = memberCount[root];
+        }
+        else
+        {
+            nextParent[j] = j;
+        }
+    }
+    parent.swap(nextParent);
+}
+
+void EllerGenerator::emitLinkRow(uint64_t *words)
+{
+    for (int j = 0; j < cellCols; j++)
+    {
+        if (goesDown[j])
+        {
+            openCell(words, 2 * j + 1);
+        }
+    }
+}
+
+bool EllerGenerator::nextRow(uint64_t *words)
+{
+    if (nextGridRow >= rows)
+    {
+        return false;
+    }
+
+    fill(words, words + wordsPerRow(cols), uint64_t(0));
+
+    int r = nextGridRow++;
+    if (r == 0 || r == rows - 1)
+    {
+        return true;
+    }
+
+    if (r % 2 == 1)
+    {
+        emitCellRow(words, r == rows - 2);
+    }
+    else
+    {
+        emitLinkRow(words);
+    }
+    return true;
+}
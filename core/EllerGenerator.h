@@ -0,0 +1,59 @@
+#ifndef MAZE_ELLER_GENERATOR_H
+#define MAZE_ELLER_GENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Random.h"
+
+// Row-band maze generator based on Eller's algorithm. It produces the maze one
+// grid row at a time and only keeps state for the current row, so memory grows
+// with the width of the maze and not with its area. This makes it suitable for
+// streaming mazes far larger than RAM straight to disk.
+//
+// Rows are emitted as packed bit rows: bit (col % 64) of word (col / 64) is set
+// when the cell is open. Dimensions must be odd and at least 3; the outer ring
+// is always wall.
+class EllerGenerator
+{
+private:
+    int rows, cols;
+    int cellCols;
+    int nextGridRow;
+    Xoshiro256 gen;
+    uint64_t randomBits;
+    int randomBitsLeft;
+
+    // Per-row union-find over cell columns; roots are column indices.
+    std::vector<int> parent;
+    std::vector<int> nextParent;
+    std::vector<int> rootOf;
+    std::vector<int> downCount;
+    std::vector<int> memberCount;
+    std::vector<int> candidate;
+    std::vector<uint8_t> goesDown;
+
+    int find(int col);
+    bool randomBit();
+    void emitCellRow(uint64_t *words, bool lastRow);
+    void emitLinkRow(uint64_t *words);
+
+public:
+    EllerGenerator(int rows, int cols, uint64_t seed);
+    EllerGenerator() : EllerGenerator(3, 3, 0) {}
+
+    // Starts over on a new maze, reusing the row state buffers.
+    void reset(int newRows, int newCols, uint64_t seed);
+
+    size_t scratchBytes() const;
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    static size_t wordsPerRow(int cols) { return (static_cast<size_t>(cols) + 63) / 64; }
+
+    // Writes the next grid row into words (wordsPerRow(cols) entries). Returns
+    // false once every row has been produced.
+    bool nextRow(uint64_t *words);
+};
+
+#endif
@@ -0,0 +1,45 @@
+#include "FrameBuffer.h"
+
+#include <algorithm>
+
+using namespace std;
+
+void FrameBuffer::resize(int newWidth, int newHeight)
+{
+    if (newWidth == width && newHeight == height)
+    {
+        return;
+    }
+    width = max(newWidth, 0);
+    height = max(newHeight, 0);
+    front.assign(static_cast<size_t>(width) * height, {' ', ConsoleColor::LIGHTGRAY});
+    back.assign(front.size(), {' ', ConsoleColor::LIGHTGRAY});
+    frontValid = false;
+}
+
+void FrameBuffer::clear(ConsoleColor color)
+{
+    fill(back.begin(), back.end(), Cell{' ', color});
+}
+
+void FrameBuffer::text(int x, int y, const string &s, ConsoleColor color)
+{
+    for (size_t i = 0; i < s.size(); i++)
+    {
+        put(x + static_cast<int>(i), y, s[i], color);
+    }
+}
+
+void FrameBuffer::box(int left, int top, int boxWidth, int boxHeight, char border, ConsoleColor color)
+{
+    for (int i = 0; i < boxWidth; i++)
+    {
+        put(left + i, top, border, color);
+        put(left + i, top + boxHeight - 1, border, color);
+    }
+    for (int i = 1; i < boxHeight - 1; i++)
+    {
+        put(left, top + i, border, color);
+        put(left + boxWidth - 1, top + i, border, color);
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef MAZE_FRAME_BUFFER_H
+#define MAZE_FRAME_BUFFER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The classic 16-colour text-mode palette, shared by every console front end.
+enum class ConsoleColor : uint8_t
+{
+    BLACK = 0,
+    BLUE = 1,
+    GREEN = 2,
+    CYAN = 3,
+    RED = 4,
+    MAGENTA = 5,
+    BROWN = 6,
+    LIGHTGRAY = 7,
+    DARKGRAY = 8,
+    LIGHTBLUE = 9,
+    LIGHTGREEN = 10,
+    LIGHTCYAN = 11,
+    LIGHTRED = 12,
+    LIGHTMAGENTA = 13,
+    YELLOW = 14,
+    WHITE = 15
+};
+
+// Double-buffered text screen. A front end draws the whole next frame into
+// the back buffer every time, then present() compares it with what is already
+// on screen and hands out only the cells that changed, as runs of adjacent
+// cells sharing one colour. A player move therefore costs a couple of short
+// writes instead of a redraw of the board.
+class FrameBuffer
+{
+public:
+    struct Cell
+    {
+        char ch;
+        ConsoleColor color;
+
+        bool operator==(const Cell &other) const { return ch == other.ch && color == other.color; }
+        bool operator!=(const Cell &other) const { return !(*this == other); }
+    };
+
+private:
+    int width, height;
+    std::vector<Cell> front;
+    std::vector<Cell> back;
+    bool frontValid;
+    std::string run;
+
+public:
+    FrameBuffer() : width(0), height(0), frontValid(false) {}
+
+    // Sets the frame size. A new size forgets what is on screen.
+    void resize(int newWidth, int newHeight);
+    // Call after the screen was changed behind the buffer's back (cleared, or
+    // another screen drawn); the next present() repaints every cell.
+    void invalidate() { frontValid = false; }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // Drawing into the back buffer. Anything outside the frame is clipped.
+    void clear(ConsoleColor color = ConsoleColor::LIGHTGRAY);
+    void put(int x, int y, char ch, ConsoleColor color)
+    {
+        if (x >= 0 && x < width && y >= 0 && y < height)
+        {
+            back[static_cast<size_t>(y) * width + x] = {ch, color};
+        }
+    }
+    void text(int x, int y, const std::string &s, ConsoleColor color);
+    // Outline only; the inside is left alone.
+    void box(int left, int top, int boxWidth, int boxHeight, char border, ConsoleColor color);
+
+    // Calls emit(x, y, text, length, color) for every run of changed cells and
+    // makes the back buffer the new front. Returns the number of changed cells.
+    template <typename Emit>
+    size_t present(Emit emit)
+    {
+        size_t changed = 0;
+        for (int y = 0; y < height; y++)
+        {
+            const Cell *next = &back[static_cast<size_t>(y) * width];
+            Cell *shown = &front[static_cast<size_t>(y) * width];
+            int x = 0;
+            while (x < width)
+            {
+                if (frontValid && next[x] == shown[x])
+                {
+                    x++;
+                    continue;
+                }
+
+                int start = x;
+                ConsoleColor color = next[x].color;
+                run.clear();
+                while (x < width && next[x].color == color && (!frontValid || next[x] != shown[x]))
+                {
+                    run += next[x].ch;
+                    shown[x] = next[x];
+                    x++;
+                }
+                changed += run.size();
+                emit(start, y, run.data(), static_cast<int>(run.size()), color);
+            }
+        }
+        frontValid = true;
+        return changed;
+    }
+};
+
+#endif
@@ -0,0 +1,336 @@
+#ifndef MAZE_GRID_H
+#define MAZE_GRID_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+// Cell bits and directions, the same for every grid layout. Every cell is a
+// single byte: the low two bits hold the cell kind, the rest are per-cell flags.
+class GridCells
+{
+public:
+    static const uint8_t KIND_WALL = 0;
+    static const uint8_t KIND_PATH = 1;
+    static const uint8_t KIND_EXIT = 2;
+    static const uint8_t KIND_PLAYER = 3;
+    static const uint8_t KIND_MASK = 0x03;
+
+    static const uint8_t TRAIL = 0x04;
+    static const uint8_t SOLUTION = 0x08;
+    static const uint8_t VISITED = 0x10; // solver scratch
+    static const uint8_t DIR_MASK = 0x60; // solver scratch: direction back to the BFS parent
+    static const int DIR_SHIFT = 5;
+
+    static const size_t ALIGNMENT = 64;
+
+    // Same order as the dx/dy tables used throughout: up, down, left, right.
+    enum Direction
+    {
+        UP = 0,
+        DOWN = 1,
+        LEFT = 2,
+        RIGHT = 3
+    };
+};
+
+// Where a layout puts (row, col). A layout maps cells to indices in a buffer
+// of size() bytes, which may include padding that is never a maze cell, and
+// steps to a neighbour; the caller makes sure the neighbour is inside the grid.
+
+// One row after another, each padded to a whole number of cache lines so it
+// starts on a line boundary. Every step is a constant offset.
+class RowMajorLayout
+{
+private:
+    size_t stride, used;
+    ptrdiff_t offsets[4];
+
+public:
+    RowMajorLayout() : stride(0), used(0), offsets{0, 0, 0, 0} {}
+
+    void resize(int rows, int cols)
+    {
+        stride = (static_cast<size_t>(cols) + GridCells::ALIGNMENT - 1) / GridCells::ALIGNMENT * GridCells::ALIGNMENT;
+        used = stride * rows;
+
+        ptrdiff_t s = static_cast<ptrdiff_t>(stride);
+        offsets[GridCells::UP] = -s;
+        offsets[GridCells::DOWN] = s;
+        offsets[GridCells::LEFT] = -1;
+        offsets[GridCells::RIGHT] = 1;
+    }
+
+    size_t size() const { return used; }
+    size_t getStride() const { return stride; }
+
+    size_t index(int row, int col) const { return static_cast<size_t>(row) * stride + col; }
+    size_t step(size_t idx, int dir) const { return idx + offsets[dir]; }
+    int rowOf(size_t idx) const { return static_cast<int>(idx / stride); }
+    int colOf(size_t idx) const { return static_cast<int>(idx % stride); }
+};
+
+// 8x8 tiles of one cache line each, the tiles in row-major order. A cell's
+// vertical neighbours share its line unless it is on a tile edge, where
+// row-major puts them a whole padded row away. A step looks its offset up by
+// the cell's position within the tile.
+class TiledLayout
+{
+public:
+    static const int TILE = 8;
+
+private:
+    size_t tileCols, used;
+    ptrdiff_t offsets[4][TILE];
+
+public:
+    TiledLayout() : tileCols(0), used(0), offsets{} {}
+
+    void resize(int rows, int cols)
+    {
+        tileCols = (static_cast<size_t>(cols) + TILE - 1) / TILE;
+        size_t tileRows = (static_cast<size_t>(rows) + TILE - 1) / TILE;
+        used = tileRows * tileCols * TILE * TILE;
+
+        ptrdiff_t tileRow = static_cast<ptrdiff_t>(tileCols) * TILE * TILE;
+        for (int k = 0; k < TILE; k++)
+        {
+            offsets[GridCells::UP][k] = k > 0 ? -TILE : -tileRow + TILE * (TILE - 1);
+            offsets[GridCells::DOWN][k] = k < TILE - 1 ? TILE : tileRow - TILE * (TILE - 1);
+            offsets[GridCells::LEFT][k] = k > 0 ? -1 : -TILE * TILE + TILE - 1;
+            offsets[GridCells::RIGHT][k] = k < TILE - 1 ? 1 : TILE * TILE - (TILE - 1);
+        }
+    }
+
+    size_t size() const { return used; }
+
+    size_t index(int row, int col) const
+    {
+        size_t tile = static_cast<size_t>(row / TILE) * tileCols + col / TILE;
+        return tile * TILE * TILE + (row % TILE) * TILE + col % TILE;
+    }
+
+    size_t step(size_t idx, int dir) const
+    {
+        // Vertical steps depend on the row within the tile (bits 3-5), horizontal
+        // ones on the column (bits 0-2).
+        int shift = dir < GridCells::LEFT ? 3 : 0;
+        return idx + offsets[dir][idx >> shift & (TILE - 1)];
+    }
+
+    int rowOf(size_t idx) const
+    {
+        return static_cast<int>(idx / (TILE * TILE) / tileCols * TILE + (idx / TILE) % TILE);
+    }
+
+    int colOf(size_t idx) const
+    {
+        return static_cast<int>(idx / (TILE * TILE) % tileCols * TILE + idx % TILE);
+    }
+};
+
+// Z-order: the bits of row and col interleaved (col in the even bits, row in
+// the odd ones), so every aligned 2^k x 2^k block is contiguous. The grid is
+// padded to a power-of-two square. A step adds or subtracts one in either bit
+// set with the other set masked out, so it never needs a division or a table.
+class MortonLayout
+{
+private:
+    static const uint64_t COL_BITS = 0x5555555555555555ULL;
+    static const uint64_t ROW_BITS = 0xaaaaaaaaaaaaaaaaULL;
+
+    size_t used;
+
+    static uint64_t spread(uint32_t v)
+    {
+        uint64_t x = v;
+        x = (x | x << 16) & 0x0000ffff0000ffffULL;
+        x = (x | x << 8) & 0x00ff00ff00ff00ffULL;
+        x = (x | x << 4) & 0x0f0f0f0f0f0f0f0fULL;
+        x = (x | x << 2) & 0x3333333333333333ULL;
+        x = (x | x << 1) & COL_BITS;
+        return x;
+    }
+
+    static uint32_t compact(uint64_t x)
+    {
+        x &= COL_BITS;
+        x = (x | x >> 1) & 0x3333333333333333ULL;
+        x = (x | x >> 2) & 0x0f0f0f0f0f0f0f0fULL;
+        x = (x | x >> 4) & 0x00ff00ff00ff00ffULL;
+        x = (x | x >> 8) & 0x0000ffff0000ffffULL;
+        x = (x | x >> 16) & 0x00000000ffffffffULL;
+        return static_cast<uint32_t>(x);
+    }
+
+public:
+    MortonLayout() : used(0) {}
+
+    void resize(int rows, int cols)
+    {
+        // Not std::max: <windows.h> may define a max macro (see Random.h).
+        size_t longest = static_cast<size_t>(rows > cols ? rows : cols);
+        size_t side = 1;
+        while (side < longest)
+        {
+            side <<= 1;
+        }
+        used = side * side;
+    }
+
+    size_t size() const { return used; }
+
+    size_t index(int row, int col) const
+    {
+        return static_cast<size_t>(spread(static_cast<uint32_t>(row)) << 1 | spread(static_cast<uint32_t>(col)));
+    }
+
+    size_t step(size_t idx, int dir) const
+    {
+        uint64_t z = idx;
+        switch (dir)
+        {
+        case GridCells::UP:
+            return static_cast<size_t>((((z & ROW_BITS) - 2) & ROW_BITS) | (z & COL_BITS));
+        case GridCells::DOWN:
+            return static_cast<size_t>((((z | COL_BITS) + 2) & ROW_BITS) | (z & COL_BITS));
+        case GridCells::LEFT:
+            return static_cast<size_t>((((z & COL_BITS) - 1) & COL_BITS) | (z & ROW_BITS));
+        default:
+            return static_cast<size_t>((((z | ROW_BITS) + 1) & COL_BITS) | (z & ROW_BITS));
+        }
+    }
+
+    int rowOf(size_t idx) const { return static_cast<int>(compact(static_cast<uint64_t>(idx) >> 1)); }
+    int colOf(size_t idx) const { return static_cast<int>(compact(idx)); }
+};
+
+// Flat, cache-aligned cell storage for the maze, laid out by Layout. The
+// game, solvers and tools all use Grid, the row-major grid; the other layouts
+// exist for the layout-generic kernels in GridKernels.h and their benchmarks.
+template <typename Layout>
+class BasicGrid : public GridCells
+{
+private:
+    struct AlignedDelete
+    {
+        void operator()(uint8_t *p) const
+        {
+            ::operator delete[](p, std::align_val_t(ALIGNMENT));
+        }
+    };
+
+    std::unique_ptr<uint8_t[], AlignedDelete> cells;
+    int rows, cols;
+    size_t capacity;
+    Layout layout;
+
+public:
+    BasicGrid() : rows(0), cols(0), capacity(0) {}
+
+    // Resizes the grid and fills every cell (padding included) with value.
+    // The buffer is only reallocated when it has to grow.
+    void assign(int newRows, int newCols, uint8_t value)
+    {
+        rows = newRows;
+        cols = newCols;
+        layout.resize(rows, cols);
+
+        size_t needed = layout.size();
+        if (needed > capacity)
+        {
+            cells.reset(static_cast<uint8_t *>(::operator new[](needed, std::align_val_t(ALIGNMENT))));
+            capacity = needed;
+        }
+        std::fill(cells.get(), cells.get() + needed, value);
+    }
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    size_t size() const { return layout.size(); }
+    // Row-major only: the padded row length in bytes.
+    size_t getStride() const { return layout.getStride(); }
+
+    size_t index(int row, int col) const { return layout.index(row, col); }
+    size_t step(size_t idx, int dir) const { return layout.step(idx, dir); }
+    int rowOf(size_t idx) const { return layout.rowOf(idx); }
+    int colOf(size_t idx) const { return layout.colOf(idx); }
+
+    bool inBounds(int row, int col) const
+    {
+        return row >= 0 && row < rows && col >= 0 && col < cols;
+    }
+
+    uint8_t *data() { return cells.get(); }
+    const uint8_t *data() const { return cells.get(); }
+
+    uint8_t &operator[](size_t idx) { return cells[idx]; }
+    uint8_t operator[](size_t idx) const { return cells[idx]; }
+    uint8_t &at(int row, int col) { return cells[index(row, col)]; }
+    uint8_t at(int row, int col) const { return cells[index(row, col)]; }
+
+    uint8_t kind(size_t idx) const { return cells[idx] & KIND_MASK; }
+    void setKind(size_t idx, uint8_t k) { cells[idx] = (cells[idx] & ~KIND_MASK) | k; }
+
+    bool has(size_t idx, uint8_t flag) const { return (cells[idx] & flag) != 0; }
+    void set(size_t idx, uint8_t flag) { cells[idx] |= flag; }
+    void clear(size_t idx, uint8_t flag) { cells[idx] &= ~flag; }
+
+    // Clears the given flag bits on every cell.
+    void clearFlags(uint8_t mask)
+    {
+        uint8_t keep = static_cast<uint8_t>(~mask);
+        uint8_t *p = cells.get();
+        size_t n = size();
+        for (size_t i = 0; i < n; i++)
+        {
+            p[i] &= keep;
+        }
+    }
+};
+
+using Grid = BasicGrid<RowMajorLayout>;
+using TiledGrid = BasicGrid<TiledLayout>;
+using MortonGrid = BasicGrid<MortonLayout>;
+
+// A row-major grid whose size is fixed at compile time, for the built-in
+// difficulty sizes. Rows are padded like Grid's, so an index means the same
+// cell in both and the cells copy across in one go. The offsets and bounds
+// are constants, and the cells live in the object itself.
+template <int Rows, int Cols>
+class FixedGrid : public GridCells
+{
+public:
+    static constexpr size_t STRIDE = (static_cast<size_t>(Cols) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    static constexpr size_t SIZE = STRIDE * Rows;
+
+private:
+    static constexpr ptrdiff_t OFFSETS[4] = {-static_cast<ptrdiff_t>(STRIDE), static_cast<ptrdiff_t>(STRIDE), -1, 1};
+
+    alignas(ALIGNMENT) std::array<uint8_t, SIZE> cells;
+
+public:
+    void fill(uint8_t value) { cells.fill(value); }
+
+    static constexpr int getRows() { return Rows; }
+    static constexpr int getCols() { return Cols; }
+    static constexpr size_t size() { return SIZE; }
+
+    static constexpr size_t index(int row, int col) { return static_cast<size_t>(row) * STRIDE + col; }
+    static constexpr size_t step(size_t idx, int dir) { return idx + OFFSETS[dir]; }
+
+    const uint8_t *data() const { return cells.data(); }
+
+    uint8_t &operator[](size_t idx) { return cells[idx]; }
+    uint8_t operator[](size_t idx) const { return cells[idx]; }
+    uint8_t &at(int row, int col) { return cells[index(row, col)]; }
+    uint8_t at(int row, int col) const { return cells[index(row, col)]; }
+
+    uint8_t kind(size_t idx) const { return cells[idx] & KIND_MASK; }
+    void setKind(size_t idx, uint8_t k) { cells[idx] = (cells[idx] & ~KIND_MASK) | k; }
+};
+
+#endif
@@ -0,0 +1,348 @@
+#ifndef MAZE_GRID_KERNELS_H
+#define MAZE_GRID_KERNELS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "Grid.h"
+#include "NextHopTable.h"
+#include "Random.h"
+
+// Maze kernels written against the BasicGrid interface only (index, step and
+// the cells), so they run unchanged on any layout. Maze instantiates them for
+// the row-major Grid and for the FixedGrid of each difficulty size; mazeBench
+// runs them on TiledGrid and MortonGrid too.
+namespace gridkernels
+{
+
+// All 24 orders of the four directions, so one random draw picks the order in
+// which a cell's neighbours are tried.
+static const uint8_t DIRECTION_ORDERS[24][4] = {
+    {0, 1, 2, 3}, {0, 1, 3, 2}, {0, 2, 1, 3}, {0, 2, 3, 1},
+    {0, 3, 1, 2}, {0, 3, 2, 1}, {1, 0, 2, 3}, {1, 0, 3, 2},
+    {1, 2, 0, 3}, {1, 2, 3, 0}, {1, 3, 0, 2}, {1, 3, 2, 0},
+    {2, 0, 1, 3}, {2, 0, 3, 1}, {2, 1, 0, 3}, {2, 1, 3, 0},
+    {2, 3, 0, 1}, {2, 3, 1, 0}, {3, 0, 1, 2}, {3, 0, 2, 1},
+    {3, 1, 0, 2}, {3, 1, 2, 0}, {3, 2, 0, 1}, {3, 2, 1, 0},
+};
+
+// Index of the nth set bit of a 4-bit direction mask.
+inline int nthDirection(unsigned mask, unsigned n)
+{
+    for (int dir = 0; dir < 4; dir++)
+    {
+        if (mask >> dir & 1 && n-- == 0)
+        {
+            return dir;
+        }
+    }
+    return -1;
+}
+
+inline unsigned countDirections(unsigned mask)
+{
+    return (mask & 1) + (mask >> 1 & 1) + (mask >> 2 & 1) + (mask >> 3 & 1);
+}
+
+// Randomized depth-first carve of an all-wall grid from (row, col), an odd
+// cell, with an explicit stack of cells. stack is scratch; it never holds more
+// than every cell once.
+template <typename GridType>
+void carveDfs(GridType &grid, int row, int col, uint64_t seed, std::vector<std::pair<int, int>> &stack)
+{
+    Xoshiro256 gen(seed);
+    const int dx[] = {-2, 2, 0, 0};
+    const int dy[] = {0, 0, -2, 2};
+    const int rows = grid.getRows();
+    const int cols = grid.getCols();
+
+    stack.clear();
+    stack.push_back({row, col});
+    grid.at(row, col) = Grid::KIND_PATH;
+
+    while (!stack.empty())
+    {
+        auto [x, y] = stack.back();
+
+        int directions[] = {0, 1, 2, 3};
+        std::shuffle(std::begin(directions), std::end(directions), gen);
+
+        bool found = false;
+        for (int dir : directions)
+        {
+            int nx = x + dx[dir];
+            int ny = y + dy[dir];
+
+            if (nx > 0 && nx < rows - 1 && ny > 0 && ny < cols - 1 && grid.at(nx, ny) == Grid::KIND_WALL)
+            {
+                grid.at(nx, ny) = Grid::KIND_PATH;
+                grid.at(x + dx[dir] / 2, y + dy[dir] / 2) = Grid::KIND_PATH;
+
+                stack.push_back({nx, ny});
+                found = true;
+                break;
+            }
+        }
+
+        if (!found)
+            stack.pop_back();
+    }
+}
+
+// Opens percent of the dead ends of a carved maze into loops, preferring a
+// wall towards another dead end so that one opening removes two of them. It
+// draws from its own stream, so a braided maze is the perfect maze with the
+// same seed plus loops.
+template <typename GridType>
+void braid(GridType &grid, int percent, uint64_t seed)
+{
+    Xoshiro256 gen(seed ^ 0x627261696421ULL);
+    const int dr[] = {-2, 2, 0, 0};
+    const int dc[] = {0, 0, -2, 2};
+    const int rows = grid.getRows();
+    const int cols = grid.getCols();
+
+    auto openSides = [&grid](size_t idx) {
+        int open = 0;
+        for (int dir = 0; dir < 4; dir++)
+        {
+            open += grid.kind(grid.step(idx, dir)) != Grid::KIND_WALL;
+        }
+        return open;
+    };
+
+    for (int r = 1; r < rows - 1; r += 2)
+    {
+        for (int c = 1; c < cols - 1; c += 2)
+        {
+            size_t idx = grid.index(r, c);
+            if (openSides(idx) != 1 || static_cast<int>(gen.below(100)) >= percent)
+            {
+                continue;
+            }
+
+            unsigned walls = 0;
+            unsigned towardsDeadEnds = 0;
+            for (int dir = 0; dir < 4; dir++)
+            {
+                int nr = r + dr[dir];
+                int nc = c + dc[dir];
+                if (nr <= 0 || nr >= rows - 1 || nc <= 0 || nc >= cols - 1 ||
+                    grid.kind(grid.step(idx, dir)) != Grid::KIND_WALL)
+                {
+                    continue;
+                }
+                walls |= 1u << dir;
+                if (openSides(grid.step(grid.step(idx, dir), dir)) == 1)
+                {
+                    towardsDeadEnds |= 1u << dir;
+                }
+            }
+
+            unsigned choices = towardsDeadEnds ? towardsDeadEnds : walls;
+            int dir = nthDirection(choices, gen.below(countDirections(choices)));
+            grid[grid.step(idx, dir)] = Grid::KIND_PATH;
+        }
+    }
+}
+
+// Randomized depth-first carve of an all-wall grid from (row, col), an odd
+// cell. The stack lives in the grid: every carved cell stores the direction
+// back to the cell it was reached from in its DIR bits, and backtracking
+// follows those, so no memory beyond the grid is used.
+template <typename GridType>
+void carveBacktrack(GridType &grid, int row, int col, uint64_t seed)
+{
+    Xoshiro256 gen(seed);
+    RandomBits random(gen);
+
+    const int dr[] = {-2, 2, 0, 0};
+    const int dc[] = {0, 0, -2, 2};
+    const int rows = grid.getRows();
+    const int cols = grid.getCols();
+    const int startRow = row;
+    const int startCol = col;
+
+    size_t idx = grid.index(row, col);
+    grid[idx] = Grid::KIND_PATH;
+
+    while (true)
+    {
+        unsigned open = 0;
+        for (int dir = 0; dir < 4; dir++)
+        {
+            int nr = row + dr[dir];
+            int nc = col + dc[dir];
+            if (nr > 0 && nr < rows - 1 && nc > 0 && nc < cols - 1 &&
+                grid[grid.step(grid.step(idx, dir), dir)] == Grid::KIND_WALL)
+            {
+                open |= 1u << dir;
+            }
+        }
+
+        if (open == 0)
+        {
+            if (row == startRow && col == startCol)
+            {
+                break;
+            }
+            int back = (grid[idx] & Grid::DIR_MASK) >> Grid::DIR_SHIFT;
+            grid[idx] = Grid::KIND_PATH;
+            idx = grid.step(grid.step(idx, back), back);
+            row += dr[back];
+            col += dc[back];
+            continue;
+        }
+
+        // The first open neighbour in a uniformly random order is a uniform
+        // choice among the open ones. A single candidate needs no random bits.
+        int dir = 0;
+        if ((open & (open - 1)) == 0)
+        {
+            while (!(open >> dir & 1))
+            {
+                dir++;
+            }
+        }
+        else
+        {
+            unsigned order;
+            do
+            {
+                order = random.take(5);
+            } while (order >= 24);
+
+            const uint8_t *dirs = DIRECTION_ORDERS[order];
+            for (int k = 0; k < 4; k++)
+            {
+                if (open >> dirs[k] & 1)
+                {
+                    dir = dirs[k];
+                    break;
+                }
+            }
+        }
+
+        size_t wall = grid.step(idx, dir);
+        grid[wall] = Grid::KIND_PATH;
+        idx = grid.step(wall, dir);
+        row += dr[dir];
+        col += dc[dir];
+        // Directions pair up as up/down and left/right, so dir ^ 1 points back.
+        grid[idx] = static_cast<uint8_t>(Grid::KIND_PATH | (dir ^ 1) << Grid::DIR_SHIFT);
+    }
+}
+
+// Breadth-first search from source over every non-wall cell. distance is
+// indexed like the grid and receives -1 for unreached cells; queue is scratch.
+// When hops is not null it receives each reached cell's first step back
+// towards source, the lowest direction where there are several. The outer
+// ring must be wall, so neighbours of an open cell never leave the grid.
+// Returns the largest distance.
+template <typename GridType>
+int32_t distanceField(const GridType &grid, size_t source, std::vector<int32_t> &distance,
+                      std::vector<size_t> &queue, NextHopTable *hops)
+{
+    distance.assign(grid.size(), -1);
+    queue.clear();
+    queue.push_back(source);
+    distance[source] = 0;
+
+    int32_t maxDistance = 0;
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        size_t current = queue[head];
+        int32_t nextDistance = distance[current] + 1;
+
+        for (int dir = 0; dir < 4; dir++)
+        {
+            size_t next = grid.step(current, dir);
+            if (grid.kind(next) == Grid::KIND_WALL)
+            {
+                continue;
+            }
+            if (distance[next] < 0)
+            {
+                distance[next] = nextDistance;
+                maxDistance = nextDistance;
+                queue.push_back(next);
+                if (hops)
+                {
+                    hops->set(next, dir ^ 1);
+                }
+            }
+            else if (hops && distance[next] == nextDistance && (dir ^ 1) < hops->get(next))
+            {
+                // A second way back at the same level, only possible around loops.
+                hops->set(next, dir ^ 1);
+            }
+        }
+    }
+    return maxDistance;
+}
+
+// Same result as distanceField, for grids small enough for a queue with room
+// for every cell. Each neighbour is appended and the tail only advances past
+// the new ones, so there is no branch on the (unpredictable) walls; on small
+// mazes those mispredictions are most of the search. distance and queue need
+// grid.size() and grid.size() + 4 entries; Index must hold any grid index.
+// The next hops are read off the finished field, lowest direction first,
+// which gives the same table as distanceField.
+template <typename GridType, typename Index>
+int32_t distanceFieldBranchless(const GridType &grid, size_t source, int32_t *distance, Index *queue,
+                                NextHopTable *hops)
+{
+    // -1 in every byte is -1 in every int32_t.
+    std::memset(distance, 0xff, grid.size() * sizeof(int32_t));
+    queue[0] = static_cast<Index>(source);
+    distance[source] = 0;
+
+    size_t tail = 1;
+    for (size_t head = 0; head < tail; head++)
+    {
+        size_t current = queue[head];
+        int32_t nextDistance = distance[current] + 1;
+
+        // Open and unvisited, computed with bit operations so that it stays a
+        // value rather than a branch. Unrolled by hand: each step is then a
+        // constant for grids that know their size.
+        auto visit = [&](int dir) {
+            size_t next = grid.step(current, dir);
+            int32_t seen = distance[next];
+            uint32_t fresh = static_cast<uint32_t>(grid.kind(next) != Grid::KIND_WALL) &
+                             static_cast<uint32_t>(seen) >> 31;
+            int32_t mask = -static_cast<int32_t>(fresh);
+            distance[next] = (nextDistance & mask) | (seen & ~mask);
+            queue[tail] = static_cast<Index>(next);
+            tail += fresh;
+        };
+        visit(Grid::UP);
+        visit(Grid::DOWN);
+        visit(Grid::LEFT);
+        visit(Grid::RIGHT);
+    }
+
+    if (hops)
+    {
+        for (size_t k = 1; k < tail; k++)
+        {
+            size_t idx = queue[k];
+            int dir = 0;
+            while (distance[grid.step(idx, dir)] != distance[idx] - 1)
+            {
+                dir++;
+            }
+            hops->set(idx, dir);
+        }
+    }
+    return distance[queue[tail - 1]];
+}
+
+} // namespace gridkernels
+
+#endif
@@ -0,0 +1,284 @@
+#include "InputLog.h"
+
+#include <cstring>
+
+#include "Maze.h"
+
+using namespace std;
+
+namespace
+{
+
+struct SessionHeader
+{
+    char magic[4]; // "MZI1"
+    uint8_t generator;
+    uint8_t braid;
+    uint8_t reserved[2];
+    uint32_t rows;
+    uint32_t cols;
+    uint64_t seed;
+};
+
+static_assert(sizeof(SessionHeader) == 24, "input log session header must stay 24 bytes");
+
+const uint64_t END_MARKER = 0x0F;
+const int COMMAND_BITS = 4;
+
+// True if a session header starts at pos. "MZI1" never occurs inside the
+// events: a varint that starts with 'M' is a single byte holding command 13,
+// and one that ends with it is followed by 'Z', command 10, neither of which
+// is recorded. So the reader can find the next session after a torn one.
+bool startsSession(const vector<char> &bytes, size_t pos)
+{
+    return pos + sizeof(SessionHeader) <= bytes.size() && memcmp(bytes.data() + pos, "MZI1", 4) == 0;
+}
+
+// First session header starting in [from, to), or bytes.size() if none.
+size_t findSession(const vector<char> &bytes, size_t from, size_t to)
+{
+    for (size_t pos = from; pos < to && pos < bytes.size(); pos++)
+    {
+        if (startsSession(bytes, pos))
+        {
+            return pos;
+        }
+    }
+    return bytes.size();
+}
+
+bool validHeader(const SessionHeader &header)
+{
+    return header.generator <= static_cast<uint8_t>(Generator::GROWING_TREE) && header.braid <= MAX_BRAID &&
+           header.rows >= 1 && header.rows <= MAX_DIMENSION && header.cols >= 1 && header.cols <= MAX_DIMENSION;
+}
+
+} // namespace
+
+bool applyCommand(Maze &maze, Command command)
+{
+    switch (command)
+    {
+    case Command::MOVE_UP:
+        maze.movePlayer(-1, 0);
+        return true;
+    case Command::MOVE_DOWN:
+        maze.movePlayer(1, 0);
+        return true;
+    case Command::MOVE_LEFT:
+        maze.movePlayer(0, -1);
+        return true;
+    case Command::MOVE_RIGHT:
+        maze.movePlayer(0, 1);
+        return true;
+    case Command::TOGGLE_SOLUTION:
+        maze.toggleSolution();
+        return true;
+    case Command::CLEAR_TRAIL:
+        maze.clearTrail();
+        return true;
+    case Command::RESTART:
+        maze.init(maze.getId());
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool InputRecorder::open(const string &path)
+{
+    close();
+
+    // A session left open by a crash is closed before ours starts, unless it
+    // stopped inside a varint: an END would then complete that varint, and the
+    // reader finds our header anyway.
+    char last = static_cast<char>(END_MARKER);
+    ifstream existing(path, ios::binary | ios::ate);
+    if (existing.is_open() && existing.tellg() > 0)
+    {
+        existing.seekg(-1, ios::end);
+        existing.get(last);
+    }
+    existing.close();
+
+    out.open(path, ios::binary | ios::app);
+    if (out.is_open() && last != static_cast<char>(END_MARKER) && !(last & 0x80))
+    {
+        writeVarint(END_MARKER);
+        out.flush();
+    }
+    return out.is_open();
+}
+
+void InputRecorder::close()
+{
+    if (out.is_open())
+    {
+        endSession();
+        out.close();
+    }
+}
+
+void InputRecorder::writeVarint(uint64_t value)
+{
+    char bytes[10];
+    int n = 0;
+    do
+    {
+        bytes[n] = static_cast<char>(value & 0x7F);
+        value >>= 7;
+        if (value)
+        {
+            bytes[n] |= static_cast<char>(0x80);
+        }
+        n++;
+    } while (value);
+    out.write(bytes, n);
+}
+
+void InputRecorder::beginSession(const MazeId &id, uint32_t atMs)
+{
+    if (!out.is_open())
+    {
+        return;
+    }
+    endSession();
+
+    SessionHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "MZI1", 4);
+    header.generator = static_cast<uint8_t>(id.generator);
+    header.rows = id.rows;
+    header.cols = id.cols;
+    header.seed = id.seed;
+    header.braid = id.braid;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    inSession = true;
+    lastMs = atMs;
+}
+
+void InputRecorder::record(const InputEvent &event)
+{
+    if (!inSession || !isMazeCommand(event.command))
+    {
+        return;
+    }
+    uint32_t delta = event.atMs >= lastMs ? event.atMs - lastMs : 0;
+    lastMs = event.atMs;
+    writeVarint(uint64_t(delta) << COMMAND_BITS | static_cast<uint64_t>(event.command));
+}
+
+void InputRecorder::endSession()
+{
+    if (inSession)
+    {
+        writeVarint(END_MARKER);
+        // A session is the unit we are willing to lose in a crash.
+        out.flush();
+        inSession = false;
+    }
+}
+
+bool readInputLog(const string &path, vector<RecordedSession> &sessions)
+{
+    ifstream in(path, ios::binary);
+    if (!in.good())
+    {
+        return false;
+    }
+    vector<char> bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+
+    size_t pos = 0;
+    while (pos + sizeof(SessionHeader) <= bytes.size())
+    {
+        SessionHeader header;
+        memcpy(&header, bytes.data() + pos, sizeof(header));
+        if (memcmp(header.magic, "MZI1", 4) != 0)
+        {
+            return pos > 0;
+        }
+
+        // A crash inside a header leaves it running into the next session's
+        // header; a header that is not a real maze belongs to no session. In
+        // both cases carry on from the next header after this one's start.
+        size_t next = findSession(bytes, pos + 1, pos + sizeof(header));
+        if (next == bytes.size() && !validHeader(header))
+        {
+            next = findSession(bytes, pos + 1, bytes.size());
+        }
+        if (next != bytes.size())
+        {
+            pos = next;
+            continue;
+        }
+        if (!validHeader(header))
+        {
+            return pos > 0;
+        }
+        pos += sizeof(header);
+
+        RecordedSession session;
+        session.id.generator = static_cast<Generator>(header.generator);
+        session.id.rows = static_cast<int>(header.rows);
+        session.id.cols = static_cast<int>(header.cols);
+        session.id.seed = header.seed;
+        session.id.braid = header.braid;
+
+        uint32_t atMs = 0;
+        while (pos < bytes.size())
+        {
+            uint64_t value = 0;
+            int shift = 0;
+            size_t start = pos;
+            bool nextSession = false;
+            while (pos < bytes.size() && shift < 64)
+            {
+                if (startsSession(bytes, pos))
+                {
+                    nextSession = true;
+                    break;
+                }
+                uint8_t b = static_cast<uint8_t>(bytes[pos++]);
+                value |= uint64_t(b & 0x7F) << shift;
+                shift += 7;
+                if (!(b & 0x80))
+                {
+                    break;
+                }
+            }
+            if (nextSession)
+            {
+                break; // this session was torn and the next one starts here
+            }
+            if (static_cast<uint8_t>(bytes[pos - 1]) & 0x80)
+            {
+                pos = start;
+                break; // torn varint at the end of the file
+            }
+            if (value == END_MARKER)
+            {
+                break;
+            }
+            InputEvent event;
+            atMs += static_cast<uint32_t>(value >> COMMAND_BITS);
+            event.atMs = atMs;
+            event.command = static_cast<Command>(value & ((1 << COMMAND_BITS) - 1));
+            if (isMazeCommand(event.command))
+            {
+                session.events.push_back(event);
+            }
+        }
+        sessions.push_back(move(session));
+    }
+    return true;
+}
+
+bool ReplayInput::next(InputEvent &event)
+{
+    if (position == session.events.size())
+    {
+        return false;
+    }
+    event = session.events[position++];
+    return true;
+}
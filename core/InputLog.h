@@ -0,0 +1,113 @@
+#ifndef MAZE_INPUT_LOG_H
+#define MAZE_INPUT_LOG_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "MazeId.h"
+
+class Maze;
+
+// Everything a player can ask for. The first group changes the maze and is
+// what gets recorded and replayed; the rest is handled by the front end.
+enum class Command : uint8_t
+{
+    MOVE_UP,
+    MOVE_DOWN,
+    MOVE_LEFT,
+    MOVE_RIGHT,
+    TOGGLE_SOLUTION,
+    CLEAR_TRAIL,
+    RESTART,
+    NEW_MAZE,
+    HIGH_SCORES,
+    PROFILE,
+    QUIT,
+    ASCEND, // layered mazes: take the stairs up or down
+    DESCEND,
+    NONE
+};
+
+inline bool isMazeCommand(Command command)
+{
+    return command <= Command::RESTART;
+}
+
+// Applies a maze command (see isMazeCommand); anything else is ignored.
+// Returns true if the command was applied.
+bool applyCommand(Maze &maze, Command command);
+
+struct InputEvent
+{
+    uint32_t atMs; // since the start of the session
+    Command command;
+};
+
+// Where a game loop gets its commands from: the keyboard, or a recording.
+class InputSource
+{
+public:
+    virtual ~InputSource() {}
+    // Waits for the next command. Returns false when the input has ended.
+    virtual bool next(InputEvent &event) = 0;
+};
+
+// A recorded play session: the maze it was played on and its maze commands.
+struct RecordedSession
+{
+    MazeId id;
+    std::vector<InputEvent> events;
+};
+
+// Writes sessions to an input log. A log is any number of sessions back to
+// back, each a 24-byte header (magic "MZI1", generator, dimensions, seed)
+// followed by one varint per event holding (delta ms << 4 | command) and an
+// END marker. A typical keystroke takes two bytes.
+class InputRecorder
+{
+private:
+    std::ofstream out;
+    bool inSession;
+    uint32_t lastMs;
+
+    void writeVarint(uint64_t value);
+
+public:
+    InputRecorder() : inSession(false), lastMs(0) {}
+    ~InputRecorder() { close(); }
+
+    // Opens path for appending, first ending a session that a crash left
+    // open. Returns false if it cannot be opened.
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const { return out.is_open(); }
+
+    // Ends the current session, if any, and starts one on id at time atMs
+    // (on the clock the events are stamped with).
+    void beginSession(const MazeId &id, uint32_t atMs = 0);
+    // Records maze commands only; other commands are ignored.
+    void record(const InputEvent &event);
+    void endSession();
+};
+
+// Reads every complete session in an input log (a session cut short by a
+// crash is kept up to its last whole event, and the sessions appended after
+// it are still read). Returns false if the file cannot
+// be read or is not an input log.
+bool readInputLog(const std::string &path, std::vector<RecordedSession> &sessions);
+
+// Plays a recorded session back as fast as it is read.
+class ReplayInput : public InputSource
+{
+private:
+    const RecordedSession &session;
+    size_t position;
+
+public:
+    explicit ReplayInput(const RecordedSession &session) : session(session), position(0) {}
+    bool next(InputEvent &event) override;
+};
+
+#endif
@@ -0,0 +1,370 @@
+#include "LayeredMaze.h"
+
+#include <algorithm>
+
+#include "MazeId.h"
+#include "Profiler.h"
+#include "Random.h"
+
+using namespace std;
+using namespace chrono;
+
+// One-cell moves in each LevelGrid::Direction.
+static const int LEVEL_STEP[] = {0, 0, 0, 0, -1, 1};
+static const int ROW_STEP[] = {-1, 1, 0, 0, 0, 0};
+static const int COL_STEP[] = {0, 0, -1, 1, 0, 0};
+
+// A uniformly chosen set bit of a direction mask.
+static int pickDirection(unsigned mask, Xoshiro256 &gen)
+{
+    unsigned count = 0;
+    for (unsigned bits = mask; bits != 0; bits &= bits - 1)
+    {
+        count++;
+    }
+    unsigned n = gen.below(count);
+    for (int dir = 0; dir < 6; dir++)
+    {
+        if (mask >> dir & 1 && n-- == 0)
+        {
+            return dir;
+        }
+    }
+    return -1;
+}
+
+void LayeredMaze::init(int rows, int cols, int levels, uint64_t newSeed, int stairsPercent)
+{
+    MAZE_PROFILE_SCOPE("generate");
+    ROWS = normalizeDimension(rows);
+    COLS = normalizeDimension(cols);
+    LEVELS = max(1, min(levels, MAX_LEVELS));
+    STAIRS_PERCENT = max(0, min(stairsPercent, 100));
+    seed = newSeed;
+
+    cells.assign(ROWS, COLS, LEVELS, Grid::KIND_WALL);
+    playerPos = {0, 1, 1};
+    exitPos = {LEVELS - 1, ROWS - 2, COLS - 2};
+    showingSolution = false;
+
+    generate();
+
+    // Every cell still points back towards the start, so the solution is the
+    // chain of parents from the exit.
+    size_t current = cells.index(exitPos.level, exitPos.row, exitPos.col);
+    optimalPathLength = 1;
+    while (true)
+    {
+        cells[current] |= Grid::SOLUTION;
+        int back = cells[current] >> DIR_SHIFT;
+        if (back == NO_PARENT)
+        {
+            break;
+        }
+        current = cells.step(current, back);
+        if (back < LevelGrid::ASCEND)
+        {
+            cells[current] |= Grid::SOLUTION;
+            current = cells.step(current, back);
+            optimalPathLength++;
+        }
+        optimalPathLength++;
+    }
+    cells.clearFlags(DIR_MASK);
+    remainingDistance = optimalPathLength - 1;
+
+    size_t exitIdx = cells.index(exitPos.level, exitPos.row, exitPos.col);
+    size_t playerIdx = cells.index(playerPos.level, playerPos.row, playerPos.col);
+    cells[exitIdx] = static_cast<uint8_t>((cells[exitIdx] & ~Grid::KIND_MASK) | Grid::KIND_EXIT);
+    cells[playerIdx] = static_cast<uint8_t>((cells[playerIdx] & ~Grid::KIND_MASK) | Grid::KIND_PLAYER);
+
+    startTime = high_resolution_clock::now();
+    elapsedSeconds = 0.0;
+    stepCount = 0;
+}
+
+void LayeredMaze::restart()
+{
+    init(ROWS, COLS, LEVELS, seed, STAIRS_PERCENT);
+}
+
+void LayeredMaze::generate()
+{
+    // Cells sit at odd rows and columns of every level. Carving along a level
+    // opens the wall between two cells; a stair joins a cell to the one
+    // directly above or below it. Visited cells are no longer wall, and each
+    // keeps the direction back to its parent in the DIR bits.
+    const int dr[] = {-2, 2, 0, 0};
+    const int dc[] = {0, 0, -2, 2};
+    Xoshiro256 gen(seed);
+
+    int level = 0;
+    int row = 1;
+    int col = 1;
+    size_t idx = cells.index(level, row, col);
+    cells[idx] = static_cast<uint8_t>(Grid::KIND_PATH | NO_PARENT << DIR_SHIFT);
+    stairCount = 0;
+
+    while (true)
+    {
+        unsigned planar = 0;
+        for (int dir = 0; dir < 4; dir++)
+        {
+            int r = row + dr[dir];
+            int c = col + dc[dir];
+            if (r > 0 && r < ROWS - 1 && c > 0 && c < COLS - 1 &&
+                (cells[cells.step(cells.step(idx, dir), dir)] & Grid::KIND_MASK) == Grid::KIND_WALL)
+            {
+                planar |= 1u << dir;
+            }
+        }
+        unsigned vertical = 0;
+        if (level > 0 && (cells[cells.step(idx, LevelGrid::ASCEND)] & Grid::KIND_MASK) == Grid::KIND_WALL)
+        {
+            vertical |= 1u << LevelGrid::ASCEND;
+        }
+        if (level < LEVELS - 1 && (cells[cells.step(idx, LevelGrid::DESCEND)] & Grid::KIND_MASK) == Grid::KIND_WALL)
+        {
+            vertical |= 1u << LevelGrid::DESCEND;
+        }
+
+        if (planar == 0 && vertical == 0)
+        {
+            int back = cells[idx] >> DIR_SHIFT;
+            if (back == NO_PARENT)
+            {
+                break;
+            }
+            if (back < LevelGrid::ASCEND)
+            {
+                idx = cells.step(cells.step(idx, back), back);
+                row += dr[back];
+                col += dc[back];
+            }
+            else
+            {
+                idx = cells.step(idx, back);
+                level += back == LevelGrid::DESCEND ? 1 : -1;
+            }
+            continue;
+        }
+
+        bool climb = vertical != 0 && (planar == 0 || gen.below(100) < static_cast<uint32_t>(STAIRS_PERCENT));
+        int dir = pickDirection(climb ? vertical : planar, gen);
+        size_t next;
+        if (dir < LevelGrid::ASCEND)
+        {
+            size_t between = cells.step(idx, dir);
+            cells[between] = Grid::KIND_PATH;
+            next = cells.step(between, dir);
+            row += dr[dir];
+            col += dc[dir];
+        }
+        else
+        {
+            next = cells.step(idx, dir);
+            level += dir == LevelGrid::DESCEND ? 1 : -1;
+        }
+        cells[next] = static_cast<uint8_t>(Grid::KIND_PATH | (dir ^ 1) << DIR_SHIFT);
+        if (dir >= LevelGrid::ASCEND)
+        {
+            // The stair flag lives on the upper of the two cells.
+            cells[dir == LevelGrid::DESCEND ? idx : next] |= STAIRS;
+            stairCount++;
+        }
+        idx = next;
+    }
+}
+
+bool LayeredMaze::canMove(size_t idx, int dir) const
+{
+    switch (dir)
+    {
+    case LevelGrid::ASCEND:
+        // From level 0 this reads the last level of the previous column,
+        // which never has a stair (and open cells are never at index 0).
+        return (cells[cells.step(idx, dir)] & STAIRS) != 0;
+    case LevelGrid::DESCEND:
+        return (cells[idx] & STAIRS) != 0;
+    default:
+        // The outer ring of every level is wall, so this never leaves the grid.
+        return (cells[cells.step(idx, dir)] & Grid::KIND_MASK) != Grid::KIND_WALL;
+    }
+}
+
+bool LayeredMaze::move(int dir)
+{
+    MAZE_PROFILE_SCOPE("movePlayer");
+    size_t from = cells.index(playerPos.level, playerPos.row, playerPos.col);
+    if (dir < 0 || dir > LevelGrid::DESCEND || !canMove(from, dir))
+    {
+        return false;
+    }
+    size_t to = cells.step(from, dir);
+
+    // In a tree the only neighbour still on the trail is the cell we came from.
+    bool backtracking = (cells[to] & Grid::TRAIL) != 0;
+    cells[from] = static_cast<uint8_t>((cells[from] & ~Grid::KIND_MASK) |
+                                       (playerPos == exitPos ? Grid::KIND_EXIT : Grid::KIND_PATH));
+    if (backtracking)
+    {
+        cells[from] &= static_cast<uint8_t>(~Grid::TRAIL);
+        cells[to] &= static_cast<uint8_t>(~Grid::TRAIL);
+    }
+    else
+    {
+        cells[from] |= Grid::TRAIL;
+    }
+
+    playerPos = {playerPos.level + LEVEL_STEP[dir], playerPos.row + ROW_STEP[dir], playerPos.col + COL_STEP[dir]};
+    stepCount++;
+
+    // The marked path runs from the exit to the player. Without loops the
+    // only marked neighbour is the previous cell on it, so a step onto a
+    // marked cell shortens the path by one and any other step extends it.
+    if (cells[to] & Grid::SOLUTION)
+    {
+        cells[from] &= static_cast<uint8_t>(~Grid::SOLUTION);
+        remainingDistance--;
+    }
+    else
+    {
+        cells[to] |= Grid::SOLUTION;
+        remainingDistance++;
+    }
+
+    if (playerPos != exitPos)
+    {
+        cells[to] = static_cast<uint8_t>((cells[to] & ~Grid::KIND_MASK) | Grid::KIND_PLAYER);
+    }
+    return true;
+}
+
+void LayeredMaze::clearTrail()
+{
+    cells.clearFlags(Grid::TRAIL);
+}
+
+int LayeredMaze::solve(long long &nodes)
+{
+    MAZE_PROFILE_SCOPE("solve");
+    size_t source = cells.index(playerPos.level, playerPos.row, playerPos.col);
+    size_t target = cells.index(exitPos.level, exitPos.row, exitPos.col);
+
+    // DIR bits hold the direction back to the parent plus one, so zero means
+    // unvisited. The queue drops its consumed front now and then; a maze's
+    // frontier is tiny next to its cell count.
+    bfsQueue.clear();
+    bfsQueue.push_back(source);
+    cells[source] |= static_cast<uint8_t>(NO_PARENT << DIR_SHIFT);
+    nodes = 0;
+    bool found = false;
+    size_t head = 0;
+    while (head < bfsQueue.size())
+    {
+        size_t current = bfsQueue[head++];
+        nodes++;
+        if (current == target)
+        {
+            found = true;
+            break;
+        }
+        for (int dir = 0; dir <= LevelGrid::DESCEND; dir++)
+        {
+            if (!canMove(current, dir))
+            {
+                continue;
+            }
+            size_t next = cells.step(current, dir);
+            if ((cells[next] & DIR_MASK) == 0)
+            {
+                cells[next] |= static_cast<uint8_t>(((dir ^ 1) + 1) << DIR_SHIFT);
+                bfsQueue.push_back(next);
+            }
+        }
+        if (head >= 4096 && 2 * head >= bfsQueue.size())
+        {
+            bfsQueue.erase(bfsQueue.begin(), bfsQueue.begin() + static_cast<ptrdiff_t>(head));
+            head = 0;
+        }
+    }
+
+    int length = 0;
+    if (found)
+    {
+        for (size_t idx = target;; length++)
+        {
+            int back = cells[idx] >> DIR_SHIFT;
+            if (back == NO_PARENT)
+            {
+                break;
+            }
+            idx = cells.step(idx, back - 1);
+        }
+        length++;
+    }
+    cells.clearFlags(DIR_MASK);
+    return length;
+}
+
+LevelPos LayeredMaze::getNextStep() const
+{
+    size_t idx = cells.index(playerPos.level, playerPos.row, playerPos.col);
+    if (!isCompleted())
+    {
+        for (int dir = 0; dir <= LevelGrid::DESCEND; dir++)
+        {
+            if (canMove(idx, dir) && (cells[cells.step(idx, dir)] & Grid::SOLUTION))
+            {
+                return {playerPos.level + LEVEL_STEP[dir], playerPos.row + ROW_STEP[dir], playerPos.col + COL_STEP[dir]};
+            }
+        }
+    }
+    return playerPos;
+}
+
+size_t LayeredMaze::getBytes() const
+{
+    return cells.size() + bfsQueue.capacity() * sizeof(size_t);
+}
+
+void LayeredMaze::updateTimer()
+{
+    auto currentTime = high_resolution_clock::now();
+    elapsedSeconds = duration_cast<milliseconds>(currentTime - startTime).count() / 1000.0;
+}
+
+CellView LayeredMaze::cellView(int level, int row, int col) const
+{
+    LevelPos pos = {level, row, col};
+    if (pos == playerPos)
+    {
+        return CellView::PLAYER;
+    }
+    else if (pos == exitPos)
+    {
+        return CellView::EXIT;
+    }
+
+    uint8_t cell = cells.at(level, row, col);
+    if ((cell & Grid::KIND_MASK) == Grid::KIND_WALL)
+    {
+        return CellView::WALL;
+    }
+    else if (showingSolution && (cell & Grid::SOLUTION))
+    {
+        return CellView::SOLUTION;
+    }
+
+    bool down = (cell & STAIRS) != 0;
+    bool up = level > 0 && (cells.at(level - 1, row, col) & STAIRS);
+    if (up || down)
+    {
+        return up && down ? CellView::STAIRS_BOTH : up ? CellView::STAIRS_UP : CellView::STAIRS_DOWN;
+    }
+    else if (cell & Grid::TRAIL)
+    {
+        return CellView::TRAIL;
+    }
+    return CellView::PATH;
+}
@@ -0,0 +1,115 @@
+#ifndef MAZE_LAYERED_MAZE_H
+#define MAZE_LAYERED_MAZE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "LevelGrid.h"
+#include "Maze.h"
+
+// A position in a layered maze.
+struct LevelPos
+{
+    int level;
+    int row;
+    int col;
+
+    bool operator==(const LevelPos &other) const
+    {
+        return level == other.level && row == other.row && col == other.col;
+    }
+    bool operator!=(const LevelPos &other) const { return !(*this == other); }
+};
+
+// A perfect maze over several levels of rows x cols cells, joined by stairs.
+// Each level is laid out like a Maze; a stair links a cell to the same cell
+// on the level below. The player starts at the top-left of level 0 and the
+// exit is at the bottom-right of the last level.
+//
+// Carving is the in-grid backtracker of Maze::generateBacktrack widened to
+// six directions, so the cells themselves hold the search and no stack is
+// needed. The maze is a tree, so the solution path is read off the carving
+// parents once and then kept in the cells' SOLUTION bits, one bit flipped per
+// move. There is no distance field or path list: a 501x501x50 maze is the
+// 12.5 MB of its cells plus a small search queue.
+class LayeredMaze
+{
+private:
+    // Cell bits on top of the Grid kind, trail and solution bits.
+    static const uint8_t STAIRS = 0x10;   // open to the same cell on the next level
+    static const uint8_t DIR_MASK = 0xe0; // scratch: direction back to the parent
+    static const int DIR_SHIFT = 5;
+    static const int NO_PARENT = 7;
+
+    int ROWS, COLS, LEVELS, STAIRS_PERCENT;
+    uint64_t seed;
+    LevelGrid cells;
+    std::vector<size_t> bfsQueue;
+    LevelPos playerPos;
+    LevelPos exitPos;
+    bool showingSolution;
+    int optimalPathLength;
+    int remainingDistance;
+    int stepCount;
+    int stairCount;
+    std::chrono::high_resolution_clock::time_point startTime;
+    double elapsedSeconds;
+
+    void generate();
+    bool canMove(size_t idx, int dir) const;
+
+public:
+    static const int MAX_LEVELS = 256;
+    static const int DEFAULT_STAIRS_PERCENT = 10;
+
+    LayeredMaze() : ROWS(0), COLS(0), LEVELS(0), STAIRS_PERCENT(0), seed(0), playerPos{0, 0, 0},
+                    exitPos{0, 0, 0}, showingSolution(false), optimalPathLength(0), remainingDistance(0),
+                    stepCount(0), stairCount(0), elapsedSeconds(0.0) {}
+
+    // rows and cols are rounded up to odd values of at least 5, levels is
+    // clamped to 1..MAX_LEVELS. Where the carver could go either along a
+    // level or up or down a stair, it takes the stair stairsPercent of the
+    // time (0 to 100); stairs it is forced onto are always taken, so every
+    // cell stays reachable.
+    void init(int rows, int cols, int levels, uint64_t seed, int stairsPercent = DEFAULT_STAIRS_PERCENT);
+    // Regenerates the current maze and puts the player back at the start.
+    void restart();
+
+    // Moves one step in a LevelGrid::Direction. Level changes need a stair.
+    // Returns true if the player moved.
+    bool move(int dir);
+    void toggleSolution() { showingSolution = !showingSolution; }
+    void clearTrail();
+
+    // Breadth-first search from the player to the exit over all six
+    // directions, independent of the stored solution path. Returns the path
+    // length in cells (0 if unreachable); nodes receives the cells expanded.
+    int solve(long long &nodes);
+
+    bool isCompleted() const { return playerPos == exitPos; }
+    int getRows() const { return ROWS; }
+    int getCols() const { return COLS; }
+    int getLevels() const { return LEVELS; }
+    uint64_t getSeed() const { return seed; }
+    int getStairsPercent() const { return STAIRS_PERCENT; }
+    const LevelPos &getPlayerPosition() const { return playerPos; }
+    const LevelPos &getExitPosition() const { return exitPos; }
+    bool isShowingSolution() const { return showingSolution; }
+    int getPathLength() const { return stepCount; }
+    int getOptimalPathLength() const { return optimalPathLength; }
+    int getRemainingDistance() const { return remainingDistance; }
+    int getStairCount() const { return stairCount; }
+    // The neighbouring cell to move to next (the player's own cell at the exit).
+    LevelPos getNextStep() const;
+    // Bytes held by the cells and the search queue.
+    size_t getBytes() const;
+
+    void updateTimer();
+    double getElapsedTime() const { return elapsedSeconds; }
+
+    CellView cellView(int level, int row, int col) const;
+};
+
+#endif
@@ -0,0 +1,797 @@
+#include "Maze.h"
+
+#include "EllerGenerator.h"
+#include "GridKernels.h"
+#include "Profiler.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <thread>
+
+using namespace std;
+using namespace chrono;
+
+// The built-in difficulties, in Difficulty order. Mazes of these sizes are
+// built on a FixedGrid of the same size (see buildFixedSize).
+struct DifficultySize
+{
+    int rows;
+    int cols;
+    int braid;
+};
+static constexpr DifficultySize DIFFICULTY_SIZES[] = {{11, 19, 20}, {15, 27, 30}, {21, 39, 40}};
+
+// Grids with at least this many cells (about 2000x2000) build their distance
+// field with ParallelBfs when more than one thread is available to it (see
+// setDistanceThreads).
+static const size_t PARALLEL_MIN_CELLS = size_t(1) << 22;
+
+NextHopTable *Maze::prepareNextHops()
+{
+    if (!nextHopsEnabled)
+    {
+        nextHops.clear();
+        return nullptr;
+    }
+    nextHops.assign(maze.size());
+    return &nextHops;
+}
+
+void Maze::computeDistanceField()
+{
+    // Breadth-first search from the exit over flat indices. The exit never moves,
+    // so this runs once per maze and every later path query is a walk down the
+    // gradient. The outer ring is always wall, so neighbours of an open cell
+    // never leave the grid.
+    size_t target = maze.index(exitPos.first, exitPos.second);
+
+    unsigned threads = distanceThreads > 0 ? distanceThreads : thread::hardware_concurrency();
+    if (maze.size() >= PARALLEL_MIN_CELLS && threads > 1)
+    {
+        if (!parallelBfs)
+        {
+            parallelBfs = make_unique<ParallelBfs>(threads);
+        }
+        long long visited;
+        parallelBfs->run(maze, target, distance, SIZE_MAX, visited);
+        if (NextHopTable *hops = prepareNextHops())
+        {
+            // The parallel search keeps no parents, so read them off the gradient.
+            for (size_t idx = 0; idx < maze.size(); idx++)
+            {
+                if (distance[idx] > 0)
+                {
+                    hops->set(idx, gradientDirection(idx));
+                }
+            }
+        }
+        return;
+    }
+
+    gridkernels::distanceField(maze, target, distance, bfsQueue, prepareNextHops());
+}
+
+int Maze::gradientDirection(size_t idx) const
+{
+    int32_t want = distance[idx] - 1;
+    for (int dir = 0; dir < 4; dir++)
+    {
+        if (distance[maze.step(idx, dir)] == want)
+        {
+            return dir;
+        }
+    }
+    return -1;
+}
+
+size_t Maze::downhill(size_t idx) const
+{
+    if (!nextHops.empty())
+    {
+        return maze.step(idx, nextHops.get(idx));
+    }
+    int dir = gradientDirection(idx);
+    return dir < 0 ? idx : maze.step(idx, dir);
+}
+
+void Maze::findSolutionPath()
+{
+    MAZE_PROFILE_SCOPE("findSolutionPath");
+    for (size_t idx : solutionPath)
+    {
+        maze.clear(idx, Grid::SOLUTION);
+    }
+    solutionPath.clear();
+
+    size_t current = maze.index(playerPos.first, playerPos.second);
+    if (distance[current] < 0)
+    {
+        return;
+    }
+
+    // Collected player-first, then reversed so the player ends up at the back.
+    while (true)
+    {
+        solutionPath.push_back(current);
+        maze.set(current, Grid::SOLUTION);
+        if (distance[current] == 0)
+        {
+            break;
+        }
+        current = downhill(current);
+    }
+    reverse(solutionPath.begin(), solutionPath.end());
+}
+
+void Maze::updateSolutionPath(size_t from, size_t to)
+{
+    // Neighbouring cells always differ in distance by exactly one (the grid graph
+    // is bipartite), so a step either follows the current path or leads away
+    // from it. Both cases are a single push/pop at the player end.
+    if (solutionPath.size() >= 2 && solutionPath[solutionPath.size() - 2] == to)
+    {
+        maze.clear(from, Grid::SOLUTION);
+        solutionPath.pop_back();
+    }
+    else if (!solutionPath.empty() && distance[to] == distance[from] + 1)
+    {
+        maze.set(to, Grid::SOLUTION);
+        solutionPath.push_back(to);
+    }
+    else
+    {
+        // Downhill but off the marked path: only possible in mazes with loops.
+        findSolutionPath();
+    }
+}
+
+void Maze::init(Difficulty difficulty)
+{
+    init(difficulty, randomSeed());
+}
+
+void Maze::init(Difficulty difficulty, uint64_t seed)
+{
+    const DifficultySize &size = DIFFICULTY_SIZES[static_cast<int>(difficulty)];
+    ROWS = size.rows;
+    COLS = size.cols;
+    WALL_DENSITY = size.braid;
+
+    build(Generator::DFS, seed);
+}
+
+void Maze::init(int rows, int cols, Generator generator)
+{
+    init(rows, cols, generator, randomSeed());
+}
+
+void Maze::init(int rows, int cols, Generator generator, uint64_t seed, int braidPercent)
+{
+    ROWS = normalizeDimension(rows);
+    COLS = normalizeDimension(cols);
+    WALL_DENSITY = max(0, min(braidPercent, MAX_BRAID));
+
+    build(generator, seed);
+}
+
+void Maze::init(const MazeId &mazeId)
+{
+    init(mazeId.rows, mazeId.cols, mazeId.generator, mazeId.seed, mazeId.braid);
+}
+
+uint64_t Maze::randomSeed()
+{
+    random_device rd;
+    return (uint64_t(rd()) << 32) | rd();
+}
+
+void Maze::build(Generator generator, uint64_t seed)
+{
+    MAZE_PROFILE_SCOPE("generate");
+    id.generator = generator;
+    id.rows = ROWS;
+    id.cols = COLS;
+    id.seed = seed;
+    id.braid = static_cast<uint8_t>(WALL_DENSITY);
+
+    maze.assign(ROWS, COLS, Grid::KIND_WALL);
+    solutionPath.clear();
+    playerPath.clear();
+
+    playerPos = {1, 1};
+    exitPos = {ROWS - 2, COLS - 2};
+    showingSolution = false;
+
+    if (!buildFixedSize(generator, seed))
+    {
+        switch (generator)
+        {
+        case Generator::DFS:
+            generateDfs(seed);
+            break;
+        case Generator::BACKTRACK:
+            generateBacktrack(seed);
+            break;
+        case Generator::ELLER:
+            generateEller(seed);
+            break;
+        case Generator::KRUSKAL:
+            generateKruskal(seed);
+            break;
+        case Generator::WILSON:
+            generateWilson(seed);
+            break;
+        case Generator::BINARY_TREE:
+            generateBinaryTree(seed);
+            break;
+        case Generator::SIDEWINDER:
+            generateSidewinder(seed);
+            break;
+        case Generator::GROWING_TREE:
+            generateGrowingTree(seed);
+            break;
+        }
+        if (WALL_DENSITY > 0)
+        {
+            gridkernels::braid(maze, WALL_DENSITY, seed);
+        }
+
+        maze.setKind(maze.index(exitPos.first, exitPos.second), Grid::KIND_EXIT);
+        maze.setKind(maze.index(playerPos.first, playerPos.second), Grid::KIND_PLAYER);
+        computeDistanceField();
+    }
+
+    // Cells sit on odd rows and columns with a wall or an opening between
+    // neighbours, so a path that never holds a cell twice (the solution and
+    // the player's trail) has fewer entries than twice the number of cells.
+    // Reserved from the size alone, neither grows after the first maze of a
+    // size, whatever its seed or braid.
+    size_t longestPath = 2 * static_cast<size_t>(ROWS / 2) * (COLS / 2);
+    solutionPath.reserve(longestPath);
+    playerPath.reserve(longestPath);
+
+    playerPath.push_back(playerPos);
+    findSolutionPath();
+    optimalPathLength = static_cast<int>(solutionPath.size());
+
+    startTime = high_resolution_clock::now();
+    elapsedSeconds = 0.0;
+    stepCount = 0;
+}
+
+bool Maze::buildFixedSize(Generator generator, uint64_t seed)
+{
+    if (!fixedSizeKernels || (generator != Generator::DFS && generator != Generator::BACKTRACK))
+    {
+        return false;
+    }
+    constexpr DifficultySize EASY = DIFFICULTY_SIZES[0];
+    constexpr DifficultySize MEDIUM = DIFFICULTY_SIZES[1];
+    constexpr DifficultySize HARD = DIFFICULTY_SIZES[2];
+    if (ROWS == EASY.rows && COLS == EASY.cols)
+    {
+        buildFixed<EASY.rows, EASY.cols>(generator, seed);
+    }
+    else if (ROWS == MEDIUM.rows && COLS == MEDIUM.cols)
+    {
+        buildFixed<MEDIUM.rows, MEDIUM.cols>(generator, seed);
+    }
+    else if (ROWS == HARD.rows && COLS == HARD.cols)
+    {
+        buildFixed<HARD.rows, HARD.cols>(generator, seed);
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+template <int Rows, int Cols>
+void Maze::buildFixed(Generator generator, uint64_t seed)
+{
+    // Carving, braiding and the distance field on a grid the compiler knows
+    // the size of: every offset and bounds check is a constant. The cells are
+    // then copied into the Grid, whose indices are the same.
+    FixedGrid<Rows, Cols> cells;
+    cells.fill(Grid::KIND_WALL);
+    if (generator == Generator::DFS)
+    {
+        dfsStack.reserve(static_cast<size_t>(Rows / 2) * (Cols / 2));
+        gridkernels::carveDfs(cells, playerPos.first, playerPos.second, seed, dfsStack);
+    }
+    else
+    {
+        gridkernels::carveBacktrack(cells, playerPos.first, playerPos.second, seed);
+    }
+    if (WALL_DENSITY > 0)
+    {
+        gridkernels::braid(cells, WALL_DENSITY, seed);
+    }
+
+    size_t target = cells.index(exitPos.first, exitPos.second);
+    cells.setKind(target, Grid::KIND_EXIT);
+    cells.setKind(cells.index(playerPos.first, playerPos.second), Grid::KIND_PLAYER);
+    copy(cells.data(), cells.data() + cells.size(), maze.data());
+
+    array<uint16_t, FixedGrid<Rows, Cols>::SIZE + 4> queue;
+    distance.resize(cells.size());
+    gridkernels::distanceFieldBranchless(cells, target, distance.data(), queue.data(), prepareNextHops());
+}
+
+void Maze::generateDfs(uint64_t seed)
+{
+    // The stack never holds more than every cell once.
+    dfsStack.reserve(static_cast<size_t>(ROWS / 2) * (COLS / 2));
+    gridkernels::carveDfs(maze, playerPos.first, playerPos.second, seed, dfsStack);
+}
+
+void Maze::generateBacktrack(uint64_t seed)
+{
+    // Same randomized depth-first search as generateDfs, but the stack lives in
+    // the grid, so no memory beyond the grid is used whatever the maze size.
+    gridkernels::carveBacktrack(maze, playerPos.first, playerPos.second, seed);
+}
+
+void Maze::generateEller(uint64_t seed)
+{
+    eller.reset(ROWS, COLS, seed);
+    ellerRow.resize(EllerGenerator::wordsPerRow(COLS));
+
+    for (int r = 0; eller.nextRow(ellerRow.data()); r++)
+    {
+        for (int c = 0; c < COLS; c++)
+        {
+            if (ellerRow[c >> 6] >> (c & 63) & 1)
+            {
+                maze.at(r, c) = Grid::KIND_PATH;
+            }
+        }
+    }
+}
+
+void Maze::generateKruskal(uint64_t seed)
+{
+    // Randomized Kruskal: every wall between two cells in random order, knocked
+    // down whenever the cells on either side are not connected yet. Connectivity
+    // is a union-find over cells with path halving. Walls are numbered
+    // cell << 1 | (0 = east, 1 = south).
+    Xoshiro256 gen(seed);
+    uint32_t cellRows = (ROWS - 1) / 2;
+    uint32_t cellCols = (COLS - 1) / 2;
+    uint32_t cells = cellRows * cellCols;
+
+    kruskalWalls.clear();
+    kruskalWalls.reserve(2 * static_cast<size_t>(cells));
+    for (uint32_t i = 0; i < cellRows; i++)
+    {
+        for (uint32_t j = 0; j < cellCols; j++)
+        {
+            maze.at(2 * i + 1, 2 * j + 1) = Grid::KIND_PATH;
+            uint32_t cell = i * cellCols + j;
+            if (j + 1 < cellCols)
+            {
+                kruskalWalls.push_back(cell << 1);
+            }
+            if (i + 1 < cellRows)
+            {
+                kruskalWalls.push_back(cell << 1 | 1);
+            }
+        }
+    }
+    shuffle(kruskalWalls.begin(), kruskalWalls.end(), gen);
+
+    cellSets.resize(cells);
+    iota(cellSets.begin(), cellSets.end(), 0u);
+    auto find = [this](uint32_t cell) {
+        while (cellSets[cell] != cell)
+        {
+            cellSets[cell] = cellSets[cellSets[cell]];
+            cell = cellSets[cell];
+        }
+        return cell;
+    };
+
+    uint32_t joined = 1;
+    for (uint32_t wall : kruskalWalls)
+    {
+        uint32_t a = wall >> 1;
+        uint32_t south = wall & 1;
+        uint32_t rootA = find(a);
+        uint32_t rootB = find(a + (south ? cellCols : 1));
+        if (rootA == rootB)
+        {
+            continue;
+        }
+        cellSets[rootA] = rootB;
+        maze.at(2 * (a / cellCols) + 1 + south, 2 * (a % cellCols) + 2 - south) = Grid::KIND_PATH;
+        if (++joined == cells)
+        {
+            break;
+        }
+    }
+}
+
+void Maze::generateWilson(uint64_t seed)
+{
+    // Wilson's algorithm: a random walk from every cell not yet in the maze
+    // until it hits the maze, then the walk with its loops erased is carved.
+    // This samples uniformly from all perfect mazes. The walk keeps the last
+    // direction it left each cell by in the DIR bits, so coming back to a cell
+    // simply overwrites (erases) the loop, and no memory beyond the grid is used.
+    Xoshiro256 gen(seed);
+    RandomBits random(gen);
+
+    const int dr[] = {-2, 2, 0, 0};
+    const int dc[] = {0, 0, -2, 2};
+    ptrdiff_t stride = static_cast<ptrdiff_t>(maze.getStride());
+    const ptrdiff_t offset[] = {-2 * stride, 2 * stride, -2, 2};
+
+    maze.at(exitPos.first, exitPos.second) = Grid::KIND_PATH;
+
+    for (int r = 1; r < ROWS - 1; r += 2)
+    {
+        for (int c = 1; c < COLS - 1; c += 2)
+        {
+            size_t start = maze.index(r, c);
+            int row = r;
+            int col = c;
+            size_t idx = start;
+            while (maze.kind(idx) == Grid::KIND_WALL)
+            {
+                int dir;
+                do
+                {
+                    dir = static_cast<int>(random.take(2));
+                } while (row + dr[dir] <= 0 || row + dr[dir] >= ROWS - 1 || col + dc[dir] <= 0 ||
+                         col + dc[dir] >= COLS - 1);
+                maze[idx] = static_cast<uint8_t>(dir << Grid::DIR_SHIFT);
+                idx += offset[dir];
+                row += dr[dir];
+                col += dc[dir];
+            }
+
+            idx = start;
+            while (maze.kind(idx) == Grid::KIND_WALL)
+            {
+                int dir = (maze[idx] & Grid::DIR_MASK) >> Grid::DIR_SHIFT;
+                maze[idx] = Grid::KIND_PATH;
+                maze[idx + offset[dir] / 2] = Grid::KIND_PATH;
+                idx += offset[dir];
+            }
+        }
+    }
+}
+
+void Maze::generateBinaryTree(uint64_t seed)
+{
+    // Every cell links to its neighbour above or to its left, picked by one
+    // random bit; the top row can only go left and the left column only up.
+    // Each row is a straight loop over one random word per 64 cells with no
+    // data-dependent branches. All paths lead towards the top-left corner, so
+    // these mazes have a strong diagonal bias.
+    Xoshiro256 gen(seed);
+    int cellCols = (COLS - 1) / 2;
+
+    for (int r = 1; r < ROWS - 1; r += 2)
+    {
+        uint8_t *row = &maze.at(r, 0);
+        uint8_t *above = &maze.at(r - 1, 0);
+        uint64_t bits = 0;
+        for (int j = 0; j < cellCols; j++)
+        {
+            if ((j & 63) == 0)
+            {
+                bits = gen();
+            }
+            bool up = r > 1 && (j == 0 || (bits >> (j & 63) & 1));
+            bool left = !up && j > 0;
+            row[2 * j + 1] = Grid::KIND_PATH;
+            row[2 * j] = left ? Grid::KIND_PATH : Grid::KIND_WALL;
+            above[2 * j + 1] = up ? Grid::KIND_PATH : Grid::KIND_WALL;
+        }
+    }
+}
+
+void Maze::generateSidewinder(uint64_t seed)
+{
+    // Row by row: each cell either extends the current run to the east or
+    // closes it, and a closed run links up through one of its cells picked at
+    // random. The top row is a single corridor. Only one row is ever touched.
+    Xoshiro256 gen(seed);
+    RandomBits random(gen);
+    int cellCols = (COLS - 1) / 2;
+
+    for (int r = 1; r < ROWS - 1; r += 2)
+    {
+        uint8_t *row = &maze.at(r, 0);
+        uint8_t *above = &maze.at(r - 1, 0);
+        int runStart = 0;
+        for (int j = 0; j < cellCols; j++)
+        {
+            row[2 * j + 1] = Grid::KIND_PATH;
+            bool last = j + 1 == cellCols;
+            if (!last && (r == 1 || random.take(1)))
+            {
+                row[2 * j + 2] = Grid::KIND_PATH;
+            }
+            else if (r > 1)
+            {
+                int member = runStart + static_cast<int>(gen.below(j - runStart + 1));
+                above[2 * member + 1] = Grid::KIND_PATH;
+                runStart = j + 1;
+            }
+        }
+    }
+}
+
+void Maze::generateGrowingTree(uint64_t seed)
+{
+    // Keeps a list of cells that may still have unvisited neighbours and grows
+    // the maze from one of them at a time: the newest (like DFS, long
+    // corridors) or a random one (like Prim's, short branches), half the time
+    // each. Finished cells are swapped out for the last entry.
+    Xoshiro256 gen(seed);
+    RandomBits random(gen);
+    int cellCols = (COLS - 1) / 2;
+
+    const int dr[] = {-2, 2, 0, 0};
+    const int dc[] = {0, 0, -2, 2};
+    ptrdiff_t stride = static_cast<ptrdiff_t>(maze.getStride());
+    const ptrdiff_t offset[] = {-2 * stride, 2 * stride, -2, 2};
+    const int cellStep[] = {-cellCols, cellCols, -1, 1};
+
+    growingCells.clear();
+    growingCells.push_back(static_cast<uint32_t>((playerPos.first / 2) * cellCols + playerPos.second / 2));
+    maze.at(playerPos.first, playerPos.second) = Grid::KIND_PATH;
+
+    while (!growingCells.empty())
+    {
+        size_t pick = random.take(1) ? growingCells.size() - 1 : gen.below(static_cast<uint32_t>(growingCells.size()));
+        uint32_t cell = growingCells[pick];
+        int row = 2 * static_cast<int>(cell / cellCols) + 1;
+        int col = 2 * static_cast<int>(cell % cellCols) + 1;
+        size_t idx = maze.index(row, col);
+
+        unsigned open = 0;
+        for (int dir = 0; dir < 4; dir++)
+        {
+            int nr = row + dr[dir];
+            int nc = col + dc[dir];
+            if (nr > 0 && nr < ROWS - 1 && nc > 0 && nc < COLS - 1 && maze[idx + offset[dir]] == Grid::KIND_WALL)
+            {
+                open |= 1u << dir;
+            }
+        }
+
+        if (open == 0)
+        {
+            growingCells[pick] = growingCells.back();
+            growingCells.pop_back();
+            continue;
+        }
+
+        int dir = gridkernels::nthDirection(open, gen.below(gridkernels::countDirections(open)));
+        maze[idx + offset[dir] / 2] = Grid::KIND_PATH;
+        maze[idx + offset[dir]] = Grid::KIND_PATH;
+        growingCells.push_back(cell + cellStep[dir]);
+    }
+}
+
+size_t Maze::getGeneratorScratchBytes() const
+{
+    return dfsStack.capacity() * sizeof(dfsStack[0]) + ellerRow.capacity() * sizeof(uint64_t) + eller.scratchBytes() +
+           (kruskalWalls.capacity() + cellSets.capacity() + growingCells.capacity()) * sizeof(uint32_t);
+}
+
+void Maze::movePlayer(int dx, int dy)
+{
+    MAZE_PROFILE_SCOPE("movePlayer");
+    int newX = playerPos.first + dx;
+    int newY = playerPos.second + dy;
+
+    if (isValidMove(newX, newY))
+    {
+        size_t oldIdx = maze.index(playerPos.first, playerPos.second);
+        size_t newIdx = maze.index(newX, newY);
+
+        if (playerPos != exitPos)
+        {
+            maze.setKind(oldIdx, Grid::KIND_PATH);
+        }
+        else
+        {
+            maze.setKind(oldIdx, Grid::KIND_EXIT);
+        }
+
+        if (!maze.has(newIdx, Grid::TRAIL))
+        {
+            maze.set(oldIdx, Grid::TRAIL);
+            playerPath.push_back({newX, newY});
+        }
+        else
+        {
+            // Back onto the trail: one step back, or around a loop of a
+            // braided maze. The trail is cut back to that cell, so it never
+            // holds a cell twice.
+            while (playerPath.back() != make_pair(newX, newY))
+            {
+                maze.clear(maze.index(playerPath.back().first, playerPath.back().second), Grid::TRAIL);
+                playerPath.pop_back();
+            }
+            maze.clear(newIdx, Grid::TRAIL);
+        }
+
+        playerPos = {newX, newY};
+        stepCount++;
+        updateSolutionPath(oldIdx, newIdx);
+
+        if (playerPos != exitPos)
+        {
+            maze.setKind(newIdx, Grid::KIND_PLAYER);
+        }
+    }
+}
+
+void Maze::clearVisited()
+{
+    // SOLUTION marks always mirror solutionPath and are only drawn while the
+    // solution is shown, so only scratch bits need resetting here.
+    maze.clearFlags(Grid::VISITED | Grid::DIR_MASK);
+    showingSolution = false;
+}
+
+void Maze::clearTrail()
+{
+    maze.clearFlags(Grid::TRAIL);
+
+    playerPath.clear();
+    playerPath.push_back(playerPos);
+}
+
+void Maze::toggleSolution()
+{
+    showingSolution = !showingSolution;
+
+    if (!showingSolution)
+    {
+        clearVisited();
+    }
+}
+
+void Maze::updateTimer()
+{
+    auto currentTime = high_resolution_clock::now();
+    elapsedSeconds = duration_cast<milliseconds>(currentTime - startTime).count() / 1000.0;
+}
+
+void Maze::setSolver(SolverKind kind)
+{
+    if (kind != solverKind || !solver)
+    {
+        solverKind = kind;
+        solver = makeSolver(kind);
+    }
+}
+
+bool Maze::solve(vector<pair<int, int>> &path, SolveStats &stats)
+{
+    MAZE_PROFILE_SCOPE("solve");
+    setSolver(solverKind);
+    return solver->solve(maze, playerPos, exitPos, path, stats);
+}
+
+pair<int, int> Maze::getNextStep() const
+{
+    if (solutionPath.size() < 2)
+    {
+        return playerPos;
+    }
+    size_t next = solutionPath[solutionPath.size() - 2];
+    return {maze.rowOf(next), maze.colOf(next)};
+}
+
+pair<int, int> Maze::getNextHop(int row, int col) const
+{
+    size_t idx = maze.index(row, col);
+    if (!nextHops.empty())
+    {
+        // Walls and the exit are told apart by the cell byte, so a lookup
+        // never touches the much larger distance field.
+        uint8_t kind = maze.kind(idx);
+        if (kind == Grid::KIND_WALL || kind == Grid::KIND_EXIT)
+        {
+            return {row, col};
+        }
+        static const int dx[] = {-1, 1, 0, 0};
+        static const int dy[] = {0, 0, -1, 1};
+        int dir = nextHops.get(idx);
+        return {row + dx[dir], col + dy[dir]};
+    }
+    if (distance.empty() || distance[idx] <= 0)
+    {
+        return {row, col};
+    }
+    size_t next = downhill(idx);
+    return {maze.rowOf(next), maze.colOf(next)};
+}
+
+CellView Maze::cellView(int row, int col) const
+{
+    uint8_t cell = maze.at(row, col);
+    uint8_t kind = cell & Grid::KIND_MASK;
+
+    if (row == playerPos.first && col == playerPos.second)
+    {
+        return CellView::PLAYER;
+    }
+    else if (row == exitPos.first && col == exitPos.second)
+    {
+        return CellView::EXIT;
+    }
+    else if (showingSolution && (cell & Grid::SOLUTION))
+    {
+        return CellView::SOLUTION;
+    }
+    else if ((cell & Grid::TRAIL) && kind == Grid::KIND_PATH)
+    {
+        return CellView::TRAIL;
+    }
+    else if (kind == Grid::KIND_WALL)
+    {
+        return CellView::WALL;
+    }
+    return CellView::PATH;
+}
+
+char Maze::glyph(CellView view)
+{
+    switch (view)
+    {
+    case CellView::WALL:
+        return WALL;
+    case CellView::PLAYER:
+        return PLAYER;
+    case CellView::EXIT:
+        return EXIT;
+    case CellView::TRAIL:
+        return TRAIL;
+    case CellView::SOLUTION:
+        return SOLUTION;
+    case CellView::STAIRS_UP:
+        return STAIRS_UP;
+    case CellView::STAIRS_DOWN:
+        return STAIRS_DOWN;
+    case CellView::STAIRS_BOTH:
+        return STAIRS_BOTH;
+    default:
+        return PATH;
+    }
+}
+
+ConsoleColor Maze::color(CellView view)
+{
+    switch (view)
+    {
+    case CellView::PLAYER:
+        return ConsoleColor::LIGHTGREEN;
+    case CellView::EXIT:
+        return ConsoleColor::LIGHTMAGENTA;
+    case CellView::SOLUTION:
+        return ConsoleColor::LIGHTRED;
+    case CellView::TRAIL:
+        return ConsoleColor::YELLOW;
+    case CellView::WALL:
+        return ConsoleColor::BLUE;
+    case CellView::STAIRS_UP:
+    case CellView::STAIRS_DOWN:
+    case CellView::STAIRS_BOTH:
+        return ConsoleColor::LIGHTCYAN;
+    default:
+        return ConsoleColor::LIGHTGRAY;
+    }
+}
@@ -0,0 +1,205 @@
+#ifndef MAZE_MAZE_H
+#define MAZE_MAZE_H
+
+#include <chrono>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "EllerGenerator.h"
+#include "FrameBuffer.h"
+#include "Grid.h"
+#include "MazeId.h"
+#include "NextHopTable.h"
+#include "ParallelBfs.h"
+#include "Solver.h"
+
+enum class Difficulty
+{
+    EASY,
+    MEDIUM,
+    HARD
+};
+
+// What a single maze cell should look like on screen. Front ends draw these
+// with Maze::glyph and Maze::color; the core never talks to a console.
+enum class CellView
+{
+    WALL,
+    PATH,
+    PLAYER,
+    EXIT,
+    TRAIL,
+    SOLUTION,
+    // Layered mazes only: stairs to the level above, below, or both.
+    STAIRS_UP,
+    STAIRS_DOWN,
+    STAIRS_BOTH
+};
+
+class Maze
+{
+private:
+    static constexpr char WALL = '#';
+    static constexpr char PATH = ' ';
+    static constexpr char PLAYER = 'P';
+    static constexpr char EXIT = 'E';
+    static constexpr char SOLUTION = '+';
+    static constexpr char TRAIL = '.';
+    static constexpr char STAIRS_UP = '<';
+    static constexpr char STAIRS_DOWN = '>';
+    static constexpr char STAIRS_BOTH = 'X';
+
+    // WALL_DENSITY is the braid percentage, see MazeId::braid.
+    int ROWS, COLS, WALL_DENSITY;
+    MazeId id;
+    Grid maze;
+    std::vector<size_t> bfsQueue;
+    // Cells from the start of the trail to the player; a step back pops.
+    std::vector<std::pair<int, int>> playerPath;
+    // Generator scratch, kept between mazes so that generating and moving
+    // allocate nothing once the buffers have grown to the maze size.
+    std::vector<std::pair<int, int>> dfsStack;
+    std::vector<uint64_t> ellerRow;
+    EllerGenerator eller;
+    std::vector<uint32_t> kruskalWalls;
+    std::vector<uint32_t> cellSets;
+    std::vector<uint32_t> growingCells;
+    std::pair<int, int> playerPos;
+    std::pair<int, int> exitPos;
+    bool showingSolution;
+    // Distance (in steps) from every cell to the exit, -1 for walls. Indexed
+    // like the grid and computed once per maze.
+    std::vector<int32_t> distance;
+    // Optional first step towards the exit from every cell, built in the same
+    // pass as the distance field. Ties go to the lowest direction, as in
+    // downhill(), so paths are the same with or without it.
+    NextHopTable nextHops;
+    bool nextHopsEnabled;
+    bool fixedSizeKernels;
+    unsigned distanceThreads;
+    std::unique_ptr<ParallelBfs> parallelBfs;
+    // Grid indices of the current shortest path, stored from the exit back to
+    // the player so that a move only touches the back of the vector.
+    std::vector<size_t> solutionPath;
+    int optimalPathLength;
+    SolverKind solverKind;
+    std::unique_ptr<Solver> solver;
+    std::chrono::high_resolution_clock::time_point startTime;
+    double elapsedSeconds;
+    int stepCount;
+
+    bool isValidMove(int x, int y) const
+    {
+        return maze.inBounds(x, y) && maze.kind(maze.index(x, y)) != Grid::KIND_WALL;
+    }
+
+    NextHopTable *prepareNextHops();
+    void computeDistanceField();
+    int gradientDirection(size_t idx) const;
+    size_t downhill(size_t idx) const;
+    void findSolutionPath();
+    void updateSolutionPath(size_t from, size_t to);
+    void build(Generator generator, uint64_t seed);
+    bool buildFixedSize(Generator generator, uint64_t seed);
+    template <int Rows, int Cols>
+    void buildFixed(Generator generator, uint64_t seed);
+    void generateDfs(uint64_t seed);
+    void generateBacktrack(uint64_t seed);
+    void generateEller(uint64_t seed);
+    void generateKruskal(uint64_t seed);
+    void generateWilson(uint64_t seed);
+    void generateBinaryTree(uint64_t seed);
+    void generateSidewinder(uint64_t seed);
+    void generateGrowingTree(uint64_t seed);
+
+public:
+    Maze() : ROWS(0), COLS(0), WALL_DENSITY(0), showingSolution(false), nextHopsEnabled(false), fixedSizeKernels(true),
+             distanceThreads(0), optimalPathLength(0),
+             solverKind(SolverKind::BFS), elapsedSeconds(0.0), stepCount(0) {}
+
+    // Overloads without a seed draw one from std::random_device; getId() still
+    // reports it, so every maze can be regenerated later.
+    void init(Difficulty difficulty);
+    void init(Difficulty difficulty, uint64_t seed);
+    // Custom dimensions. Both are rounded up to odd values of at least 5.
+    // braidPercent of the dead ends (0 to MAX_BRAID) are opened into loops.
+    void init(int rows, int cols, Generator generator = Generator::DFS);
+    void init(int rows, int cols, Generator generator, uint64_t seed, int braidPercent = 0);
+    // Regenerates exactly the maze described by the ID.
+    void init(const MazeId &mazeId);
+    // A fresh seed from std::random_device.
+    static uint64_t randomSeed();
+    void movePlayer(int dx, int dy);
+    void clearVisited();
+    void clearTrail();
+    void toggleSolution();
+
+    bool isCompleted() const
+    {
+        return playerPos == exitPos;
+    }
+
+    const MazeId &getId() const { return id; }
+    const Grid &getGrid() const { return maze; }
+    int getRows() const { return ROWS; }
+    int getCols() const { return COLS; }
+    const std::pair<int, int> &getPlayerPosition() const { return playerPos; }
+    const std::pair<int, int> &getExitPosition() const { return exitPos; }
+    bool isShowingSolution() const { return showingSolution; }
+    int getPathLength() const { return stepCount; }
+    int getOptimalPathLength() const { return optimalPathLength; }
+    // Steps left to the exit along the shortest path.
+    int getRemainingDistance() const
+    {
+        return distance.empty() ? 0 : distance[maze.index(playerPos.first, playerPos.second)];
+    }
+    // Steps from (row, col) to the exit, -1 for walls.
+    int getDistance(int row, int col) const
+    {
+        return distance.empty() ? -1 : distance[maze.index(row, col)];
+    }
+    // The neighbouring cell to move to next (the player's own cell once at the exit).
+    std::pair<int, int> getNextStep() const;
+    // The neighbour of any open cell one step closer to the exit, or the cell
+    // itself for walls and the exit. A single lookup with the next-hop table.
+    std::pair<int, int> getNextHop(int row, int col) const;
+    // Builds the next-hop table (2 bits per cell) from the next init on.
+    void setNextHopTable(bool enabled) { nextHopsEnabled = enabled; }
+    bool hasNextHopTable() const { return !nextHops.empty(); }
+    size_t getNextHopTableBytes() const { return nextHops.bytes(); }
+    // Mazes of the difficulty sizes carved with DFS or the backtracker are
+    // built on a grid sized at compile time (on by default). The mazes are the
+    // same either way; turning it off is for benchmarks and checks.
+    void setFixedSizeKernels(bool enabled) { fixedSizeKernels = enabled; }
+    // Threads for the distance field of very large grids (about 2000x2000 and
+    // up): 0, the default, uses every hardware thread and 1 keeps the search
+    // on the calling thread.
+    void setDistanceThreads(unsigned threads)
+    {
+        distanceThreads = threads;
+        parallelBfs.reset();
+    }
+    void updateTimer();
+
+    double getElapsedTime() const
+    {
+        return elapsedSeconds;
+    }
+
+    // Picks the search algorithm used by solve().
+    void setSolver(SolverKind kind);
+    SolverKind getSolver() const { return solverKind; }
+    // Searches from the player to the exit with the selected solver. The path
+    // runs from the player to the exit, both included.
+    bool solve(std::vector<std::pair<int, int>> &path, SolveStats &stats);
+    // Bytes held by generator scratch buffers (the grid and distance field
+    // not included).
+    size_t getGeneratorScratchBytes() const;
+
+    CellView cellView(int row, int col) const;
+    static char glyph(CellView view);
+    static ConsoleColor color(CellView view);
+};
+
+#endif
@@ -0,0 +1,325 @@
+#include "MazeFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "EllerGenerator.h"
+#include "Maze.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static const uint64_t SECTION_ALIGNMENT = 64;
+
+static uint64_t alignSection(uint64_t offset)
+{
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+MazeFileHeader makeMazeFileHeader(int rows, int cols)
+{
+    MazeFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "MZF1", 4);
+    header.version = MAZE_FILE_VERSION;
+    header.rows = rows;
+    header.cols = cols;
+    header.rowWords = BitGrid::paddedRowWords(cols);
+    header.gridOffset = alignSection(sizeof(MazeFileHeader));
+    return header;
+}
+
+bool writeMazeFile(const string &path, const Maze &maze, bool withDistances)
+{
+    int rows = maze.getRows();
+    int cols = maze.getCols();
+    BitGrid bits;
+    bits.fromGrid(maze.getGrid());
+
+    MazeFileHeader header = makeMazeFileHeader(rows, cols);
+    header.generator = static_cast<uint8_t>(maze.getId().generator);
+    header.seed = maze.getId().seed;
+    header.braid = maze.getId().braid;
+    header.optimalPathLength = maze.getOptimalPathLength();
+    uint64_t gridEnd = header.gridOffset + bits.bytes();
+    if (withDistances)
+    {
+        header.flags |= MAZE_FILE_HAS_DISTANCES;
+        header.distanceOffset = alignSection(gridEnd);
+    }
+
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out.good())
+    {
+        return false;
+    }
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.seekp(header.gridOffset);
+    out.write(reinterpret_cast<const char *>(bits.row(0)), bits.bytes());
+
+    if (withDistances)
+    {
+        static const char zeros[SECTION_ALIGNMENT] = {};
+        out.write(zeros, header.distanceOffset - gridEnd);
+        vector<int32_t> row(cols);
+        for (int r = 0; r < rows; r++)
+        {
+            for (int c = 0; c < cols; c++)
+            {
+                row[c] = maze.getDistance(r, c);
+            }
+            out.write(reinterpret_cast<const char *>(row.data()), cols * sizeof(int32_t));
+        }
+    }
+    return out.good();
+}
+
+#ifdef _WIN32
+
+MappedMaze::MappedMaze() : base(nullptr), length(0), file(INVALID_HANDLE_VALUE), mapping(nullptr) {}
+
+bool MappedMaze::open(const string &path)
+{
+    close();
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(MazeFileHeader)))
+    {
+        close();
+        return false;
+    }
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        close();
+        return false;
+    }
+    base = static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    length = static_cast<size_t>(size.QuadPart);
+    if (base == nullptr || !validate())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedMaze::close()
+{
+    if (base != nullptr)
+    {
+        UnmapViewOfFile(base);
+    }
+    if (mapping != nullptr)
+    {
+        CloseHandle(mapping);
+    }
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(file);
+    }
+    base = nullptr;
+    length = 0;
+    mapping = nullptr;
+    file = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+MappedMaze::MappedMaze() : base(nullptr), length(0) {}
+
+bool MappedMaze::open(const string &path)
+{
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(MazeFileHeader)))
+    {
+        ::close(fd);
+        return false;
+    }
+    void *address = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps its own reference to the file.
+    ::close(fd);
+    if (address == MAP_FAILED)
+    {
+        return false;
+    }
+    base = static_cast<const uint8_t *>(address);
+    length = static_cast<size_t>(info.st_size);
+    if (!validate())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedMaze::close()
+{
+    if (base != nullptr)
+    {
+        munmap(const_cast<uint8_t *>(base), length);
+    }
+    base = nullptr;
+    length = 0;
+}
+
+#endif
+
+MappedMaze::~MappedMaze()
+{
+    close();
+}
+
+bool MappedMaze::validate() const
+{
+    const MazeFileHeader &h = header();
+    if (memcmp(h.magic, "MZF1", 4) != 0 || h.version != MAZE_FILE_VERSION)
+    {
+        return false;
+    }
+    if (h.rows < 3 || h.cols < 3 || h.rows > INT32_MAX || h.cols > INT32_MAX ||
+        h.rowWords < EllerGenerator::wordsPerRow(h.cols))
+    {
+        return false;
+    }
+
+    // Everything BitBfs and solve() read must lie inside the mapping, aligned.
+    uint64_t words = (length - min<uint64_t>(length, h.gridOffset)) / sizeof(uint64_t);
+    if (h.gridOffset % sizeof(uint64_t) != 0 || h.gridOffset < sizeof(MazeFileHeader) ||
+        h.rowWords > words / h.rows)
+    {
+        return false;
+    }
+    if (h.flags & MAZE_FILE_HAS_DISTANCES)
+    {
+        uint64_t cells = (length - min<uint64_t>(length, h.distanceOffset)) / sizeof(int32_t);
+        if (h.distanceOffset % sizeof(int32_t) != 0 || h.distanceOffset < sizeof(MazeFileHeader) ||
+            h.cols > cells / h.rows)
+        {
+            return false;
+        }
+    }
+
+    // The searches rely on the outer ring being wall.
+    BitGridView view = grid();
+    for (size_t w = 0; w < view.rowWords; w++)
+    {
+        if (view.words[w] != 0 || view.words[(view.rows - 1) * view.rowWords + w] != 0)
+        {
+            return false;
+        }
+    }
+    for (int r = 1; r < view.rows - 1; r++)
+    {
+        if (view.isOpen(r, 0) || view.isOpen(r, view.cols - 1))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+MazeId MappedMaze::id() const
+{
+    const MazeFileHeader &h = header();
+    MazeId result;
+    result.generator = static_cast<Generator>(h.generator);
+    result.rows = static_cast<int>(h.rows);
+    result.cols = static_cast<int>(h.cols);
+    result.seed = h.seed;
+    result.braid = h.braid;
+    return result;
+}
+
+BitGridView MappedMaze::grid() const
+{
+    const MazeFileHeader &h = header();
+    return {reinterpret_cast<const uint64_t *>(base + h.gridOffset), static_cast<int>(h.rows),
+            static_cast<int>(h.cols), static_cast<size_t>(h.rowWords)};
+}
+
+const int32_t *MappedMaze::distances() const
+{
+    const MazeFileHeader &h = header();
+    if (!(h.flags & MAZE_FILE_HAS_DISTANCES))
+    {
+        return nullptr;
+    }
+    return reinterpret_cast<const int32_t *>(base + h.distanceOffset);
+}
+
+bool MappedMaze::solve(BitBfs &bfs, vector<pair<int, int>> &path, long long &visited) const
+{
+    const MazeFileHeader &h = header();
+    int rows = static_cast<int>(h.rows);
+    int cols = static_cast<int>(h.cols);
+    pair<int, int> start(1, 1);
+    pair<int, int> goal(rows - 2, cols - 2);
+
+    const int32_t *dist = distances();
+    if (dist == nullptr)
+    {
+        return bfs.solve(grid(), start, goal, path, visited);
+    }
+
+    // Walk downhill; each step goes to a neighbour one step closer to the exit.
+    static const int DR[] = {-1, 1, 0, 0};
+    static const int DC[] = {0, 0, -1, 1};
+    path.clear();
+    visited = 0;
+    pair<int, int> current = start;
+    int32_t left = dist[static_cast<size_t>(current.first) * cols + current.second];
+    if (left < 0)
+    {
+        return false;
+    }
+    path.push_back(current);
+    while (left > 0)
+    {
+        int dir = 0;
+        for (; dir < 4; dir++)
+        {
+            int r = current.first + DR[dir];
+            int c = current.second + DC[dir];
+            bool inside = r > 0 && c > 0 && r < rows - 1 && c < cols - 1;
+            if (inside && dist[static_cast<size_t>(r) * cols + c] == left - 1)
+            {
+                current = {r, c};
+                break;
+            }
+        }
+        if (dir == 4)
+        {
+            // Inconsistent field; don't loop forever on a corrupt file.
+            path.clear();
+            return false;
+        }
+        path.push_back(current);
+        left--;
+    }
+    visited = static_cast<long long>(path.size());
+    return current == goal;
+}
@@ -0,0 +1,95 @@
+#ifndef MAZE_MAZE_FILE_H
+#define MAZE_MAZE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BitGrid.h"
+#include "MazeId.h"
+
+class Maze;
+
+// A single maze on disk, laid out so it can be memory-mapped and used as is:
+//
+//   MazeFileHeader                 64 bytes
+//   bit grid                       at gridOffset, `rows` rows of rowWords words
+//   distance field (optional)      at distanceOffset, rows * cols int32_t
+//
+// The bit grid is in BitGridView format with rows padded to
+// BitGrid::paddedRowWords, so BitBfs can search the mapping directly. The
+// distance field holds the steps from each cell to the exit (row-major, -1 for
+// walls). The player starts at (1, 1) and the exit is at (rows - 2, cols - 2).
+// Multi-byte fields are little-endian.
+struct MazeFileHeader
+{
+    char magic[4]; // "MZF1"
+    uint16_t version;
+    uint16_t flags;
+    uint32_t rows;
+    uint32_t cols;
+    uint8_t generator;
+    uint8_t braid; // MazeId::braid, 0 in files written before braiding existed
+    uint8_t reserved0[6];
+    uint64_t seed;
+    uint64_t rowWords;
+    uint64_t gridOffset;
+    uint64_t distanceOffset; // 0 without a distance field
+    uint32_t optimalPathLength; // cells on the shortest path, 0 if unknown
+    uint32_t reserved1;
+};
+
+static_assert(sizeof(MazeFileHeader) == 64, "maze file header must stay 64 bytes");
+
+const uint16_t MAZE_FILE_VERSION = 1;
+const uint16_t MAZE_FILE_HAS_DISTANCES = 1;
+
+// Header for a rows x cols maze with the grid right after it and no distance
+// field; the caller fills in generator, seed and optimalPathLength.
+MazeFileHeader makeMazeFileHeader(int rows, int cols);
+
+// Saves the maze's walls, optionally with its distance field. Returns false on
+// I/O failure.
+bool writeMazeFile(const std::string &path, const Maze &maze, bool withDistances);
+
+// Read-only memory mapping of a maze file. Nothing is copied: grid() and
+// distances() point into the mapping and stay valid until close().
+class MappedMaze
+{
+private:
+    const uint8_t *base;
+    size_t length;
+#ifdef _WIN32
+    void *file;
+    void *mapping;
+#endif
+
+    bool validate() const;
+
+public:
+    MappedMaze();
+    ~MappedMaze();
+    MappedMaze(const MappedMaze &) = delete;
+    MappedMaze &operator=(const MappedMaze &) = delete;
+
+    // Maps path and checks the header, the sizes and the wall ring. Returns
+    // false (and leaves nothing open) if any of that fails.
+    bool open(const std::string &path);
+    void close();
+
+    bool isOpen() const { return base != nullptr; }
+    const MazeFileHeader &header() const { return *reinterpret_cast<const MazeFileHeader *>(base); }
+    MazeId id() const;
+    BitGridView grid() const;
+    // Row-major distances to the exit, or nullptr if the file has none.
+    const int32_t *distances() const;
+
+    // Shortest path from the start to the exit, both included. Follows the
+    // distance field when there is one and searches the grid with bfs
+    // otherwise; visited receives the cells the search reached.
+    bool solve(BitBfs &bfs, std::vector<std::pair<int, int>> &path, long long &visited) const;
+};
+
+#endif
@@ -0,0 +1,153 @@
+#include "MazeId.h"
+
+#include <cerrno>
+#include <cstdlib>
+
+using namespace std;
+
+static const char DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+// Parses a decimal rows or cols value: digits only, 1 to MAX_DIMENSION.
+static bool parseDimension(const string &text, int &value)
+{
+    if (text.empty() || text[0] < '0' || text[0] > '9')
+    {
+        return false;
+    }
+    char *end = nullptr;
+    errno = 0;
+    long parsed = strtol(text.c_str(), &end, 10);
+    if (*end != '\0' || errno == ERANGE || parsed <= 0 || parsed > MAX_DIMENSION)
+    {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+const char *generatorName(Generator generator)
+{
+    switch (generator)
+    {
+    case Generator::ELLER:
+        return "eller";
+    case Generator::BACKTRACK:
+        return "backtrack";
+    case Generator::KRUSKAL:
+        return "kruskal";
+    case Generator::WILSON:
+        return "wilson";
+    case Generator::BINARY_TREE:
+        return "binarytree";
+    case Generator::SIDEWINDER:
+        return "sidewinder";
+    case Generator::GROWING_TREE:
+        return "growingtree";
+    default:
+        return "dfs";
+    }
+}
+
+bool parseGenerator(const string &name, Generator &generator)
+{
+    if (name == "dfs")
+        generator = Generator::DFS;
+    else if (name == "eller")
+        generator = Generator::ELLER;
+    else if (name == "backtrack")
+        generator = Generator::BACKTRACK;
+    else if (name == "kruskal")
+        generator = Generator::KRUSKAL;
+    else if (name == "wilson")
+        generator = Generator::WILSON;
+    else if (name == "binarytree")
+        generator = Generator::BINARY_TREE;
+    else if (name == "sidewinder")
+        generator = Generator::SIDEWINDER;
+    else if (name == "growingtree")
+        generator = Generator::GROWING_TREE;
+    else
+        return false;
+    return true;
+}
+
+string MazeId::toString() const
+{
+    string encoded;
+    uint64_t value = seed;
+    do
+    {
+        encoded.insert(encoded.begin(), DIGITS[value % 36]);
+        value /= 36;
+    } while (value != 0);
+
+    string text = string(generatorName(generator)) + "-" + to_string(rows) + "x" + to_string(cols) + "-" + encoded;
+    if (braid > 0)
+    {
+        text += "-b" + to_string(braid);
+    }
+    return text;
+}
+
+bool MazeId::parse(const string &text, MazeId &id)
+{
+    size_t dash1 = text.find('-');
+    size_t cross = text.find('x', dash1 + 1);
+    size_t dash2 = text.find('-', dash1 + 1);
+    if (dash1 == string::npos || cross == string::npos || dash2 == string::npos || cross > dash2)
+    {
+        return false;
+    }
+
+    MazeId parsed;
+    if (!parseGenerator(text.substr(0, dash1), parsed.generator))
+    {
+        return false;
+    }
+
+    string rows = text.substr(dash1 + 1, cross - dash1 - 1);
+    string cols = text.substr(cross + 1, dash2 - cross - 1);
+    size_t dash3 = text.find('-', dash2 + 1);
+    string seed = text.substr(dash2 + 1, dash3 == string::npos ? string::npos : dash3 - dash2 - 1);
+    if (dash3 != string::npos)
+    {
+        string braid = text.substr(dash3 + 1);
+        char *end = nullptr;
+        long value = braid.size() > 1 && braid[0] == 'b' ? strtol(braid.c_str() + 1, &end, 10) : -1;
+        if (value < 0 || value > MAX_BRAID || *end != '\0')
+        {
+            return false;
+        }
+        parsed.braid = static_cast<uint8_t>(value);
+    }
+    if (seed.empty() || seed.size() > 13 || !parseDimension(rows, parsed.rows) ||
+        !parseDimension(cols, parsed.cols))
+    {
+        return false;
+    }
+
+    // 13 base-36 digits can exceed 64 bits, so guard the accumulation.
+    uint64_t value = 0;
+    for (char ch : seed)
+    {
+        const char *digit = nullptr;
+        for (const char *d = DIGITS; *d; d++)
+        {
+            if (*d == ch)
+            {
+                digit = d;
+                break;
+            }
+        }
+        uint64_t add = digit ? static_cast<uint64_t>(digit - DIGITS) : 36;
+        if (add >= 36 || value > (UINT64_MAX - add) / 36)
+        {
+            return false;
+        }
+        value = value * 36 + add;
+    }
+    parsed.seed = value;
+
+    id = parsed;
+    return true;
+}
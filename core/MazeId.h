@@ -0,0 +1,67 @@
+#ifndef MAZE_MAZE_ID_H
+#define MAZE_MAZE_ID_H
+
+#include <cstdint>
+#include <string>
+
+// Carving algorithm used by Maze::init. DFS (randomized backtracker) is the
+// default; BACKTRACK is the same search with its stack kept inside the grid,
+// which carves large mazes faster and without extra memory (different mazes
+// for the same seed). ELLER builds the grid row by row, see EllerGenerator.
+// KRUSKAL and WILSON give mazes with many short branches (WILSON draws
+// uniformly from all perfect mazes), BINARY_TREE and SIDEWINDER carve a row at
+// a time with one random decision per cell, and GROWING_TREE mixes DFS-like
+// corridors with Prim-like branching. The values are stored in maze files and
+// packs, so new ones go at the end.
+enum class Generator
+{
+    DFS,
+    ELLER,
+    BACKTRACK,
+    KRUSKAL,
+    WILSON,
+    BINARY_TREE,
+    SIDEWINDER,
+    GROWING_TREE
+};
+
+const char *generatorName(Generator generator);
+bool parseGenerator(const std::string &name, Generator &generator);
+
+// Mazes alternate wall and cell rows/columns, so both dimensions have to be odd.
+// Even sizes are rounded up and anything below 5 is raised to 5.
+inline int normalizeDimension(int n)
+{
+    return (n < 5 ? 5 : n) | 1;
+}
+
+// Largest rows or cols an ID may name: 2^20 - 1, so that rows * cols still
+// fits easily in a 64-bit cell count and every coordinate in an int.
+const int MAX_DIMENSION = (1 << 20) - 1;
+
+// Largest braid value: every dead end is opened into a loop.
+const int MAX_BRAID = 100;
+
+// Everything needed to regenerate a maze bit for bit. The text form is
+// "<generator>-<rows>x<cols>-<seed in base 36>", e.g. "dfs-21x39-2k0laszokyfsf",
+// with "-b<braid>" appended for braided mazes ("dfs-21x39-2k0laszokyfsf-b40").
+struct MazeId
+{
+    Generator generator = Generator::DFS;
+    int rows = 0;
+    int cols = 0;
+    uint64_t seed = 0;
+    // Percentage of dead ends opened into loops after carving, 0 for a perfect maze.
+    uint8_t braid = 0;
+
+    std::string toString() const;
+    static bool parse(const std::string &text, MazeId &id);
+
+    bool operator==(const MazeId &other) const
+    {
+        return generator == other.generator && rows == other.rows && cols == other.cols && seed == other.seed &&
+               braid == other.braid;
+    }
+};
+
+#endif
@@ -0,0 +1,120 @@
+#include "MazePack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+#include "EllerGenerator.h"
+
+using namespace std;
+
+static const uint64_t PACK_ALIGNMENT = 64;
+
+size_t packedMazeWords(int rows, int cols)
+{
+    return static_cast<size_t>(rows) * EllerGenerator::wordsPerRow(cols);
+}
+
+uint64_t layoutMazePack(const vector<MazeId> &ids, vector<MazePackEntry> &entries)
+{
+    entries.assign(ids.size(), MazePackEntry());
+
+    uint64_t offset = sizeof(MazePackHeader) + ids.size() * sizeof(MazePackEntry);
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        MazePackEntry &entry = entries[i];
+        entry.rows = normalizeDimension(ids[i].rows);
+        entry.cols = normalizeDimension(ids[i].cols);
+        entry.seed = ids[i].seed;
+        entry.generator = static_cast<uint8_t>(ids[i].generator);
+        entry.braid = ids[i].braid;
+
+        offset = (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+        entry.offset = offset;
+        offset += packedMazeWords(entry.rows, entry.cols) * sizeof(uint64_t);
+    }
+    return offset;
+}
+
+MazeId packEntryId(const MazePackEntry &entry)
+{
+    MazeId id;
+    id.generator = static_cast<Generator>(entry.generator);
+    id.rows = static_cast<int>(entry.rows);
+    id.cols = static_cast<int>(entry.cols);
+    id.seed = entry.seed;
+    id.braid = entry.braid;
+    return id;
+}
+
+void packGrid(const Grid &grid, uint64_t *words)
+{
+    size_t rowWords = EllerGenerator::wordsPerRow(grid.getCols());
+    for (int i = 0; i < grid.getRows(); i++)
+    {
+        uint64_t *row = words + i * rowWords;
+        fill(row, row + rowWords, uint64_t(0));
+        size_t base = grid.index(i, 0);
+        for (int j = 0; j < grid.getCols(); j++)
+        {
+            uint64_t open = grid.kind(base + j) != Grid::KIND_WALL;
+            row[j >> 6] |= open << (j & 63);
+        }
+    }
+}
+
+bool writeMazePackIndex(ostream &out, const vector<MazePackEntry> &entries)
+{
+    MazePackHeader header;
+    memcpy(header.magic, "MZP1", 4);
+    header.count = static_cast<uint32_t>(entries.size());
+    header.reserved = 0;
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(MazePackEntry));
+    return out.good();
+}
+
+bool readMazePackIndex(istream &in, vector<MazePackEntry> &entries)
+{
+    MazePackHeader header;
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) || memcmp(header.magic, "MZP1", 4) != 0)
+    {
+        return false;
+    }
+
+    // A corrupt count or entry must fail here, not in a huge allocation: the
+    // index and every bit grid have to lie within the file.
+    in.seekg(0, ios::end);
+    streamoff length = in.tellg();
+    if (length < 0 || header.count > (static_cast<uint64_t>(length) - sizeof(header)) / sizeof(MazePackEntry))
+    {
+        return false;
+    }
+    entries.resize(header.count);
+    in.seekg(sizeof(header));
+    if (!in.read(reinterpret_cast<char *>(entries.data()), entries.size() * sizeof(MazePackEntry)))
+    {
+        return false;
+    }
+    for (const MazePackEntry &entry : entries)
+    {
+        if (entry.rows == 0 || entry.rows > MAX_DIMENSION || entry.cols == 0 || entry.cols > MAX_DIMENSION ||
+            entry.offset > static_cast<uint64_t>(length) ||
+            packedMazeWords(entry.rows, entry.cols) > (static_cast<uint64_t>(length) - entry.offset) / sizeof(uint64_t))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readPackedMaze(istream &in, const MazePackEntry &entry, vector<uint64_t> &words)
+{
+    words.resize(packedMazeWords(entry.rows, entry.cols));
+    in.seekg(static_cast<streamoff>(entry.offset));
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(words.data()), words.size() * sizeof(uint64_t)));
+}
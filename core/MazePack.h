@@ -0,0 +1,63 @@
+#ifndef MAZE_MAZE_PACK_H
+#define MAZE_MAZE_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#include "Grid.h"
+#include "MazeId.h"
+
+// A puzzle pack: many mazes in one file. Layout:
+//
+//   MazePackHeader
+//   MazePackEntry[count]           index, in maze order
+//   bit grids                      one per maze, each starting on a 64-byte boundary
+//
+// A bit grid is `rows` packed bit rows of wordsPerRow(cols) 64-bit words, the
+// same row format EllerGenerator emits (bit set = open cell). Every offset is
+// known from the IDs alone, so mazes can be written in any order and by any
+// number of writers at once.
+struct MazePackHeader
+{
+    char magic[4]; // "MZP1"
+    uint32_t count;
+    uint64_t reserved;
+};
+
+struct MazePackEntry
+{
+    uint32_t rows;
+    uint32_t cols;
+    uint64_t seed;
+    uint64_t offset; // byte offset of the bit grid from the start of the file
+    uint8_t generator;
+    uint8_t braid;
+    uint8_t reserved[2];
+    uint32_t optimalPathLength;
+};
+
+static_assert(sizeof(MazePackHeader) == 16, "pack header must stay 16 bytes");
+static_assert(sizeof(MazePackEntry) == 32, "pack entries must stay 32 bytes");
+
+// Number of 64-bit words in the bit grid of a rows x cols maze.
+size_t packedMazeWords(int rows, int cols);
+
+// Fills one entry per ID (dimensions normalised like Maze::init) with its
+// offset in the file. Returns the size of the whole file in bytes.
+uint64_t layoutMazePack(const std::vector<MazeId> &ids, std::vector<MazePackEntry> &entries);
+
+MazeId packEntryId(const MazePackEntry &entry);
+
+// Packs the open cells of grid (anything that is not a wall) into bit rows.
+// words must hold packedMazeWords(grid.getRows(), grid.getCols()) entries.
+void packGrid(const Grid &grid, uint64_t *words);
+
+bool writeMazePackIndex(std::ostream &out, const std::vector<MazePackEntry> &entries);
+// Returns false if in is not a pack, or if its index or any bit grid it
+// points at does not fit in the stream.
+bool readMazePackIndex(std::istream &in, std::vector<MazePackEntry> &entries);
+bool readPackedMaze(std::istream &in, const MazePackEntry &entry, std::vector<uint64_t> &words);
+
+#endif
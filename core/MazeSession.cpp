@@ -0,0 +1,140 @@
+#include "MazeSession.h"
+
+#include <cstring>
+
+#include "Profiler.h"
+
+using namespace std;
+
+namespace
+{
+
+struct RequestHeader
+{
+    uint8_t type;
+    uint8_t argument;
+    uint16_t sequence;
+};
+
+static_assert(sizeof(RequestHeader) == SESSION_REQUEST_HEADER, "request header must stay 4 bytes");
+
+size_t requestLength(uint8_t type)
+{
+    switch (static_cast<RequestType>(type))
+    {
+    case RequestType::COMMAND:
+    case RequestType::QUERY:
+        return SESSION_REQUEST_HEADER;
+    case RequestType::NEW_MAZE:
+        return SESSION_REQUEST_HEADER + sizeof(uint64_t);
+    default:
+        return 0;
+    }
+}
+
+} // namespace
+
+size_t encodeRequest(const SessionRequest &request, uint8_t *out)
+{
+    RequestHeader header;
+    header.type = static_cast<uint8_t>(request.type);
+    header.argument = request.argument;
+    header.sequence = request.sequence;
+    memcpy(out, &header, sizeof(header));
+
+    size_t length = requestLength(header.type);
+    if (request.type == RequestType::NEW_MAZE)
+    {
+        memcpy(out + sizeof(header), &request.seed, sizeof(request.seed));
+    }
+    return length;
+}
+
+int decodeRequest(const uint8_t *data, size_t size, SessionRequest &request)
+{
+    if (size < SESSION_REQUEST_HEADER)
+    {
+        return 0;
+    }
+    RequestHeader header;
+    memcpy(&header, data, sizeof(header));
+    size_t length = requestLength(header.type);
+    if (length == 0)
+    {
+        return -1;
+    }
+    if (size < length)
+    {
+        return 0;
+    }
+
+    request.type = static_cast<RequestType>(header.type);
+    request.argument = header.argument;
+    request.sequence = header.sequence;
+    request.seed = 0;
+    if (request.type == RequestType::NEW_MAZE)
+    {
+        memcpy(&request.seed, data + sizeof(header), sizeof(request.seed));
+    }
+    return static_cast<int>(length);
+}
+
+void MazeSession::handle(const SessionRequest &request, SessionReply &reply)
+{
+    MAZE_PROFILE_SCOPE("request");
+    memset(&reply, 0, sizeof(reply));
+    reply.sequence = request.sequence;
+
+    switch (request.type)
+    {
+    case RequestType::COMMAND:
+    {
+        Command command = static_cast<Command>(request.argument);
+        if (!isMazeCommand(command))
+        {
+            reply.status = REPLY_BAD_REQUEST;
+            return;
+        }
+        if (!started)
+        {
+            reply.status = REPLY_NO_MAZE;
+            return;
+        }
+        applyCommand(maze, command);
+        break;
+    }
+    case RequestType::NEW_MAZE:
+        if (request.argument > static_cast<uint8_t>(Difficulty::HARD))
+        {
+            reply.status = REPLY_BAD_REQUEST;
+            return;
+        }
+        if (request.seed != 0)
+        {
+            maze.init(static_cast<Difficulty>(request.argument), request.seed);
+        }
+        else
+        {
+            maze.init(static_cast<Difficulty>(request.argument));
+        }
+        started = true;
+        break;
+    default:
+        if (!started)
+        {
+            reply.status = REPLY_NO_MAZE;
+            return;
+        }
+        break;
+    }
+
+    reply.status = REPLY_OK;
+    reply.flags = (maze.isCompleted() ? REPLY_COMPLETED : 0) | (maze.isShowingSolution() ? REPLY_SHOWING_SOLUTION : 0);
+    reply.row = static_cast<uint16_t>(maze.getPlayerPosition().first);
+    reply.col = static_cast<uint16_t>(maze.getPlayerPosition().second);
+    reply.rows = static_cast<uint16_t>(maze.getRows());
+    reply.cols = static_cast<uint16_t>(maze.getCols());
+    reply.steps = static_cast<uint32_t>(maze.getPathLength());
+    reply.remaining = static_cast<uint32_t>(maze.getRemainingDistance());
+    reply.optimal = static_cast<uint32_t>(maze.getOptimalPathLength());
+}
@@ -0,0 +1,81 @@
+#ifndef MAZE_MAZE_SESSION_H
+#define MAZE_MAZE_SESSION_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "InputLog.h"
+#include "Maze.h"
+
+// Wire protocol between mazeServer and its clients. A client sends requests
+// and gets exactly one 24-byte reply per request, in order. Every request
+// starts with a 4-byte header (type, argument, sequence number); NEW_MAZE is
+// followed by a 64-bit seed. Multi-byte fields are little-endian.
+enum class RequestType : uint8_t
+{
+    COMMAND = 1,  // argument: a maze Command (move, toggle solution, clear trail, restart)
+    NEW_MAZE = 2, // argument: Difficulty; seed 0 picks a random one
+    QUERY = 3     // argument unused; replies with the current state
+};
+
+struct SessionRequest
+{
+    RequestType type = RequestType::QUERY;
+    uint8_t argument = 0;
+    uint16_t sequence = 0; // echoed in the reply
+    uint64_t seed = 0;
+};
+
+enum ReplyStatus : uint8_t
+{
+    REPLY_OK = 0,
+    REPLY_BAD_REQUEST = 1, // unknown command or difficulty
+    REPLY_NO_MAZE = 2      // a command before the first NEW_MAZE
+};
+
+const uint8_t REPLY_COMPLETED = 1;
+const uint8_t REPLY_SHOWING_SOLUTION = 2;
+
+struct SessionReply
+{
+    uint8_t status;
+    uint8_t flags;
+    uint16_t sequence;
+    uint16_t row; // player position
+    uint16_t col;
+    uint16_t rows; // maze size
+    uint16_t cols;
+    uint32_t steps;
+    uint32_t remaining; // steps left on the shortest path
+    uint32_t optimal;   // shortest path length from the start, in cells
+};
+
+static_assert(sizeof(SessionReply) == 24, "session replies must stay 24 bytes");
+
+const size_t SESSION_REQUEST_HEADER = 4;
+const size_t SESSION_REQUEST_MAX = 12;
+
+// Writes request to out (at least SESSION_REQUEST_MAX bytes) and returns its length.
+size_t encodeRequest(const SessionRequest &request, uint8_t *out);
+
+// Decodes the request at the front of data. Returns its length in bytes, 0 if
+// more bytes are needed, or -1 for an unknown request type.
+int decodeRequest(const uint8_t *data, size_t size, SessionRequest &request);
+
+// One player's game on the server. Sessions share nothing, so a server can
+// run any number of them side by side without locking as long as each one
+// is only touched by one thread at a time.
+class MazeSession
+{
+private:
+    Maze maze;
+    bool started;
+
+public:
+    MazeSession() : started(false) {}
+
+    void handle(const SessionRequest &request, SessionReply &reply);
+    const Maze &getMaze() const { return maze; }
+};
+
+#endif
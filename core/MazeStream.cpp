@@ -0,0 +1,51 @@
+#include "MazeStream.h"
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include "EllerGenerator.h"
+#include "MazeId.h"
+
+using namespace std;
+
+// Rows are collected into bands of roughly this many bytes before being written.
+static const size_t BAND_BYTES = 1 << 20;
+
+bool streamEllerMaze(const string &path, int rows, int cols, uint64_t seed)
+{
+    rows = normalizeDimension(rows);
+    cols = normalizeDimension(cols);
+
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out.good())
+    {
+        return false;
+    }
+
+    MazeFileHeader header = makeMazeFileHeader(rows, cols);
+    header.generator = static_cast<uint8_t>(Generator::ELLER);
+    header.seed = seed;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.seekp(header.gridOffset);
+
+    // The generator writes the first wordsPerRow words of each row; the rest
+    // of the padded row stays zero.
+    size_t rowWords = header.rowWords;
+    size_t bandRows = max<size_t>(1, BAND_BYTES / (rowWords * sizeof(uint64_t)));
+    vector<uint64_t> band(bandRows * rowWords);
+
+    EllerGenerator eller(rows, cols, seed);
+    size_t filled = 0;
+    while (eller.nextRow(band.data() + filled * rowWords))
+    {
+        if (++filled == bandRows)
+        {
+            out.write(reinterpret_cast<const char *>(band.data()), filled * rowWords * sizeof(uint64_t));
+            filled = 0;
+        }
+    }
+    out.write(reinterpret_cast<const char *>(band.data()), filled * rowWords * sizeof(uint64_t));
+
+    return out.good();
+}
@@ -0,0 +1,15 @@
+#ifndef MAZE_MAZE_STREAM_H
+#define MAZE_MAZE_STREAM_H
+
+#include <cstdint>
+#include <string>
+
+#include "MazeFile.h"
+
+// Generates a rows x cols maze with Eller's algorithm and writes it to path as
+// a maze file (see MazeFile.h; no distance field) in bands of rows, never
+// holding more than one band in memory. Dimensions are rounded up to odd
+// values like Maze::init. Returns false on I/O failure.
+bool streamEllerMaze(const std::string &path, int rows, int cols, uint64_t seed);
+
+#endif
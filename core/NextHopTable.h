@@ -0,0 +1,40 @@
+#ifndef MAZE_NEXT_HOP_TABLE_H
+#define MAZE_NEXT_HOP_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One Grid::Direction per cell, packed four cells to a byte: the first step
+// on a shortest path from that cell to the exit. Indexed like the Grid it was
+// built for, padding included. Entries for walls and the exit itself are
+// meaningless, so callers check the distance field first.
+class NextHopTable
+{
+private:
+    std::vector<uint8_t> hops;
+
+public:
+    // Sizes the table for cells grid indices and zeroes it. Keeps the buffer.
+    void assign(size_t cells)
+    {
+        hops.assign((cells + 3) / 4, 0);
+    }
+
+    void clear() { hops.clear(); }
+    bool empty() const { return hops.empty(); }
+    size_t bytes() const { return hops.capacity(); }
+
+    int get(size_t idx) const
+    {
+        return hops[idx >> 2] >> ((idx & 3) * 2) & 3;
+    }
+
+    void set(size_t idx, int dir)
+    {
+        int shift = static_cast<int>(idx & 3) * 2;
+        hops[idx >> 2] = static_cast<uint8_t>((hops[idx >> 2] & ~(3 << shift)) | dir << shift);
+    }
+};
+
+#endif
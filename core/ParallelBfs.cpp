@@ -0,0 +1,292 @@
+#include "ParallelBfs.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace
+{
+
+// Frontiers smaller than this are expanded on the calling thread.
+const size_t PARALLEL_MIN_FRONTIER = 2048;
+// Frontier cells per top-down task and bitmap words per bottom-up task.
+const size_t TOP_DOWN_CHUNK = 1024;
+const size_t BOTTOM_UP_CHUNK = 256;
+// Direction switch thresholds from Beamer et al.: go bottom-up once the frontier
+// exceeds 1/ALPHA of the unvisited cells, back once it drops below 1/BETA of all.
+const long long ALPHA = 14;
+const long long BETA = 24;
+
+inline int popcount64(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    int n = 0;
+    for (; x; x &= x - 1)
+    {
+        n++;
+    }
+    return n;
+#endif
+}
+
+inline int lowestBit(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1))
+    {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+} // namespace
+
+ParallelBfs::ParallelBfs(unsigned threads) : pool(threads), workers(pool.size()), closedCapacity(0)
+{
+}
+
+long long ParallelBfs::initialise(const Grid &grid, size_t words, vector<int32_t> &dist)
+{
+    if (words > closedCapacity)
+    {
+        closed.reset(new atomic<uint64_t>[words]);
+        closedCapacity = words;
+    }
+    if (dist.size() != grid.size())
+    {
+        dist.resize(grid.size());
+    }
+
+    for (WorkerState &worker : workers)
+    {
+        worker.open = 0;
+    }
+
+    size_t chunks = (words + BOTTOM_UP_CHUNK - 1) / BOTTOM_UP_CHUNK;
+    pool.run(chunks, [&](unsigned w, size_t chunk) {
+        size_t first = chunk * BOTTOM_UP_CHUNK;
+        size_t last = min(words, first + BOTTOM_UP_CHUNK);
+        long long open = 0;
+        for (size_t word = first; word < last; word++)
+        {
+            size_t base = word * 64;
+            uint64_t bits = 0;
+            for (int b = 0; b < 64; b++)
+            {
+                bits |= uint64_t(grid.kind(base + b) == Grid::KIND_WALL) << b;
+            }
+            closed[word].store(bits, memory_order_relaxed);
+            open += 64 - popcount64(bits);
+        }
+        fill(dist.begin() + first * 64, dist.begin() + last * 64, -1);
+        workers[w].open += open;
+    });
+
+    long long open = 0;
+    for (const WorkerState &worker : workers)
+    {
+        open += worker.open;
+    }
+    return open;
+}
+
+long long ParallelBfs::expandTopDown(const Grid &grid, int32_t level, vector<int32_t> &dist)
+{
+    int32_t nextLevel = level + 1;
+
+    if (frontier.size() < PARALLEL_MIN_FRONTIER || pool.size() == 1)
+    {
+        // Only this thread touches the bitmap, so plain load/store suffices.
+        vector<size_t> &next = workers[0].next;
+        next.clear();
+        for (size_t current : frontier)
+        {
+            for (int dir = 0; dir < 4; dir++)
+            {
+                size_t n = grid.step(current, dir);
+                atomic<uint64_t> &word = closed[n >> 6];
+                uint64_t bit = uint64_t(1) << (n & 63);
+                uint64_t value = word.load(memory_order_relaxed);
+                if (!(value & bit))
+                {
+                    word.store(value | bit, memory_order_relaxed);
+                    dist[n] = nextLevel;
+                    next.push_back(n);
+                }
+            }
+        }
+        frontier.swap(next);
+        return static_cast<long long>(frontier.size());
+    }
+
+    for (WorkerState &worker : workers)
+    {
+        worker.next.clear();
+    }
+
+    size_t chunks = (frontier.size() + TOP_DOWN_CHUNK - 1) / TOP_DOWN_CHUNK;
+    pool.run(chunks, [&](unsigned w, size_t chunk) {
+        vector<size_t> &next = workers[w].next;
+        size_t first = chunk * TOP_DOWN_CHUNK;
+        size_t last = min(frontier.size(), first + TOP_DOWN_CHUNK);
+        for (size_t i = first; i < last; i++)
+        {
+            size_t current = frontier[i];
+            for (int dir = 0; dir < 4; dir++)
+            {
+                size_t n = grid.step(current, dir);
+                atomic<uint64_t> &word = closed[n >> 6];
+                uint64_t bit = uint64_t(1) << (n & 63);
+                // Cheap read first; only contenders for a still-open cell pay for the RMW.
+                if ((word.load(memory_order_relaxed) & bit) || (word.fetch_or(bit, memory_order_relaxed) & bit))
+                {
+                    continue;
+                }
+                dist[n] = nextLevel;
+                next.push_back(n);
+            }
+        }
+    });
+
+    size_t total = 0;
+    for (const WorkerState &worker : workers)
+    {
+        total += worker.next.size();
+    }
+    frontier.resize(total);
+    size_t offset = 0;
+    for (const WorkerState &worker : workers)
+    {
+        copy(worker.next.begin(), worker.next.end(), frontier.begin() + offset);
+        offset += worker.next.size();
+    }
+    return static_cast<long long>(total);
+}
+
+long long ParallelBfs::expandBottomUp(const Grid &grid, size_t words, int32_t level, vector<int32_t> &dist)
+{
+    int32_t nextLevel = level + 1;
+    size_t rowWords = grid.getStride() / 64;
+
+    for (WorkerState &worker : workers)
+    {
+        worker.found = 0;
+    }
+
+    size_t chunks = (words + BOTTOM_UP_CHUNK - 1) / BOTTOM_UP_CHUNK;
+    pool.run(chunks, [&](unsigned w, size_t chunk) {
+        size_t first = chunk * BOTTOM_UP_CHUNK;
+        size_t last = min(words, first + BOTTOM_UP_CHUNK);
+        long long found = 0;
+        for (size_t word = first; word < last; word++)
+        {
+            uint64_t value = closed[word].load(memory_order_relaxed);
+            uint64_t open = ~value;
+            nextBits[word] = 0;
+            if (!open)
+            {
+                continue;
+            }
+
+            // The outer ring is wall, so words holding open cells never sit in
+            // the first or last row and all four neighbouring words exist.
+            const uint64_t *f = frontierBits.data();
+            uint64_t reached = (f[word] << 1) | (f[word - 1] >> 63);
+            reached |= (f[word] >> 1) | (f[word + 1] << 63);
+            reached |= f[word - rowWords] | f[word + rowWords];
+            reached &= open;
+            if (!reached)
+            {
+                continue;
+            }
+
+            closed[word].store(value | reached, memory_order_relaxed);
+            nextBits[word] = reached;
+            found += popcount64(reached);
+            for (uint64_t bits = reached; bits; bits &= bits - 1)
+            {
+                dist[word * 64 + lowestBit(bits)] = nextLevel;
+            }
+        }
+        workers[w].found += found;
+    });
+
+    frontierBits.swap(nextBits);
+    long long total = 0;
+    for (const WorkerState &worker : workers)
+    {
+        total += worker.found;
+    }
+    return total;
+}
+
+void ParallelBfs::listToBits(size_t words)
+{
+    frontierBits.assign(words, 0);
+    nextBits.assign(words, 0);
+    for (size_t idx : frontier)
+    {
+        frontierBits[idx >> 6] |= uint64_t(1) << (idx & 63);
+    }
+}
+
+void ParallelBfs::bitsToList(size_t words)
+{
+    frontier.clear();
+    for (size_t word = 0; word < words; word++)
+    {
+        for (uint64_t bits = frontierBits[word]; bits; bits &= bits - 1)
+        {
+            frontier.push_back(word * 64 + lowestBit(bits));
+        }
+    }
+}
+
+int32_t ParallelBfs::run(const Grid &grid, size_t source, vector<int32_t> &dist, size_t stopAt, long long &visited)
+{
+    // Rows are padded to whole cache lines, so the grid is a whole number of words.
+    size_t words = grid.size() / 64;
+    long long open = initialise(grid, words, dist);
+
+    closed[source >> 6].fetch_or(uint64_t(1) << (source & 63), memory_order_relaxed);
+    dist[source] = 0;
+    frontier.assign(1, source);
+
+    long long frontierSize = 1;
+    long long unvisited = open - 1;
+    visited = 1;
+    bool bottomUp = false;
+    int32_t level = 0;
+
+    while (frontierSize > 0 && (stopAt >= dist.size() || dist[stopAt] < 0))
+    {
+        if (!bottomUp && frontierSize > unvisited / ALPHA && frontierSize >= static_cast<long long>(PARALLEL_MIN_FRONTIER))
+        {
+            listToBits(words);
+            bottomUp = true;
+        }
+        else if (bottomUp && frontierSize < open / BETA)
+        {
+            bitsToList(words);
+            bottomUp = false;
+        }
+
+        long long found = bottomUp ? expandBottomUp(grid, words, level, dist) : expandTopDown(grid, level, dist);
+        if (found == 0)
+        {
+            break;
+        }
+        level++;
+        visited += found;
+        unvisited -= found;
+        frontierSize = found;
+    }
+    return level;
+}
@@ -0,0 +1,64 @@
+#ifndef MAZE_PARALLEL_BFS_H
+#define MAZE_PARALLEL_BFS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Grid.h"
+#include "WorkStealingPool.h"
+
+// Level-synchronous breadth-first search over a Grid on a WorkStealingPool.
+//
+// Every level is expanded either top-down (the frontier list is split into
+// chunks; workers claim unvisited neighbours with an atomic fetch_or on a
+// visited bitmap and collect them in per-thread lists) or bottom-up (every
+// unvisited cell checks whether a neighbour is in the frontier bitmap; this is
+// done 64 cells at a time with shifts and needs no atomics at all). The search
+// switches direction with the usual frontier-versus-unvisited heuristic.
+//
+// Levels with a small frontier are expanded inline on the calling thread: a
+// perfect maze is mostly long corridors, and waking the pool for a handful of
+// cells would cost far more than the cells themselves.
+class ParallelBfs
+{
+private:
+    struct alignas(64) WorkerState
+    {
+        std::vector<size_t> next;
+        long long found = 0;
+        long long open = 0;
+    };
+
+    WorkStealingPool pool;
+    std::vector<WorkerState> workers;
+
+    // Bit set = wall or already visited. One bit per grid index, padding included.
+    std::unique_ptr<std::atomic<uint64_t>[]> closed;
+    size_t closedCapacity;
+    std::vector<uint64_t> frontierBits;
+    std::vector<uint64_t> nextBits;
+    std::vector<size_t> frontier;
+
+    long long initialise(const Grid &grid, size_t words, std::vector<int32_t> &dist);
+    long long expandTopDown(const Grid &grid, int32_t level, std::vector<int32_t> &dist);
+    long long expandBottomUp(const Grid &grid, size_t words, int32_t level, std::vector<int32_t> &dist);
+    void listToBits(size_t words);
+    void bitsToList(size_t words);
+
+public:
+    // threads == 0 uses every hardware thread.
+    explicit ParallelBfs(unsigned threads = 0);
+
+    unsigned threads() const { return pool.size(); }
+
+    // Fills dist (resized to grid.size()) with the number of steps from source
+    // to every reachable open cell and -1 elsewhere. With stopAt set, the search
+    // ends after the level that reaches that cell; cells beyond it stay -1.
+    // Returns the largest distance assigned; visited receives the cell count.
+    int32_t run(const Grid &grid, size_t source, std::vector<int32_t> &dist, size_t stopAt, long long &visited);
+};
+
+#endif
@@ -0,0 +1,225 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+
+using namespace std;
+
+namespace profiler
+{
+
+namespace
+{
+
+struct ThreadCounters
+{
+    atomic<uint64_t> count[MAX_ZONES];
+    atomic<uint64_t> totalNs[MAX_ZONES];
+    atomic<uint64_t> maxNs[MAX_ZONES];
+    atomic<uint64_t> buckets[MAX_ZONES][BUCKETS];
+
+    ThreadCounters()
+    {
+        for (int z = 0; z < MAX_ZONES; z++)
+        {
+            count[z].store(0, memory_order_relaxed);
+            totalNs[z].store(0, memory_order_relaxed);
+            maxNs[z].store(0, memory_order_relaxed);
+            for (int b = 0; b < BUCKETS; b++)
+            {
+                buckets[z][b].store(0, memory_order_relaxed);
+            }
+        }
+    }
+};
+
+// Zone names and the counter blocks of every thread that ever recorded. The
+// blocks are never freed, so the counts of finished threads stay visible.
+mutex registryMutex;
+const char *zoneNames[MAX_ZONES];
+atomic<int> zoneCount(0);
+vector<ThreadCounters *> threads;
+atomic<uint64_t> lastNs[MAX_ZONES];
+
+thread_local ThreadCounters *local = nullptr;
+
+ThreadCounters &localCounters()
+{
+    if (local == nullptr)
+    {
+        local = new ThreadCounters();
+        lock_guard<mutex> lock(registryMutex);
+        threads.push_back(local);
+    }
+    return *local;
+}
+
+// Only the owning thread writes its counters, so a plain load and store is
+// enough; the atomics just keep concurrent snapshots well defined.
+void bump(atomic<uint64_t> &counter, uint64_t by)
+{
+    counter.store(counter.load(memory_order_relaxed) + by, memory_order_relaxed);
+}
+
+int bucketOf(uint64_t ns)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    int b = 63 - __builtin_clzll(ns | 1);
+#else
+    int b = 0;
+    for (uint64_t rest = ns; rest > 1; rest >>= 1)
+    {
+        b++;
+    }
+#endif
+    return b < BUCKETS ? b : BUCKETS - 1;
+}
+
+} // namespace
+
+double ZoneStats::percentileUs(double q) const
+{
+    if (count == 0)
+    {
+        return 0.0;
+    }
+    uint64_t want = static_cast<uint64_t>(q * count);
+    uint64_t seen = 0;
+    for (int b = 0; b < BUCKETS; b++)
+    {
+        seen += buckets[b];
+        if (seen > want)
+        {
+            return min(uint64_t(2) << b, maxNs) / 1000.0;
+        }
+    }
+    return maxNs / 1000.0;
+}
+
+int registerZone(const char *name)
+{
+    lock_guard<mutex> lock(registryMutex);
+    int n = zoneCount.load(memory_order_relaxed);
+    for (int z = 0; z < n; z++)
+    {
+        if (strcmp(zoneNames[z], name) == 0)
+        {
+            return z;
+        }
+    }
+    if (n == MAX_ZONES)
+    {
+        return -1;
+    }
+    zoneNames[n] = name;
+    zoneCount.store(n + 1, memory_order_release);
+    return n;
+}
+
+void record(int zone, uint64_t ns)
+{
+    if (zone < 0)
+    {
+        return;
+    }
+    ThreadCounters &c = localCounters();
+    bump(c.count[zone], 1);
+    bump(c.totalNs[zone], ns);
+    bump(c.buckets[zone][bucketOf(ns)], 1);
+    if (ns > c.maxNs[zone].load(memory_order_relaxed))
+    {
+        c.maxNs[zone].store(ns, memory_order_relaxed);
+    }
+    lastNs[zone].store(ns, memory_order_relaxed);
+}
+
+vector<ZoneStats> snapshot()
+{
+    lock_guard<mutex> lock(registryMutex);
+    vector<ZoneStats> result;
+    int n = zoneCount.load(memory_order_acquire);
+    for (int z = 0; z < n; z++)
+    {
+        ZoneStats stats;
+        stats.name = zoneNames[z];
+        stats.lastNs = lastNs[z].load(memory_order_relaxed);
+        for (ThreadCounters *c : threads)
+        {
+            stats.count += c->count[z].load(memory_order_relaxed);
+            stats.totalNs += c->totalNs[z].load(memory_order_relaxed);
+            stats.maxNs = max(stats.maxNs, c->maxNs[z].load(memory_order_relaxed));
+            for (int b = 0; b < BUCKETS; b++)
+            {
+                stats.buckets[b] += c->buckets[z][b].load(memory_order_relaxed);
+            }
+        }
+        if (stats.count > 0)
+        {
+            result.push_back(stats);
+        }
+    }
+    return result;
+}
+
+void reset()
+{
+    // Counters belong to their threads; zeroing them from here may drop an
+    // update that races with it, which is fine for statistics.
+    lock_guard<mutex> lock(registryMutex);
+    for (ThreadCounters *c : threads)
+    {
+        for (int z = 0; z < MAX_ZONES; z++)
+        {
+            c->count[z].store(0, memory_order_relaxed);
+            c->totalNs[z].store(0, memory_order_relaxed);
+            c->maxNs[z].store(0, memory_order_relaxed);
+            for (int b = 0; b < BUCKETS; b++)
+            {
+                c->buckets[z][b].store(0, memory_order_relaxed);
+            }
+        }
+    }
+}
+
+void writeJson(ostream &out)
+{
+    vector<ZoneStats> zones = snapshot();
+    out << "{\n"
+        << "  \"enabled\": " << (enabled() ? "true" : "false") << ",\n"
+        << "  \"zones\": [\n";
+    for (size_t i = 0; i < zones.size(); i++)
+    {
+        const ZoneStats &z = zones[i];
+        out << "    {\"name\": \"" << z.name << "\", \"count\": " << z.count << fixed << setprecision(3)
+            << ", \"total_us\": " << z.totalNs / 1000.0 << ", \"mean_us\": " << z.meanUs()
+            << ", \"p50_us\": " << z.percentileUs(0.5) << ", \"p99_us\": " << z.percentileUs(0.99)
+            << ", \"max_us\": " << z.maxNs / 1000.0 << "}" << (i + 1 < zones.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+vector<string> overlayLines()
+{
+    vector<string> lines;
+    if (!enabled())
+    {
+        lines.push_back("profiling off (MAZE_ENABLE_PROFILING)");
+        return lines;
+    }
+    lines.push_back("zone              last us   mean us    p99 us");
+    for (const ZoneStats &z : snapshot())
+    {
+        char line[96];
+        snprintf(line, sizeof(line), "%-16.16s %8.1f %9.1f %9.1f", z.name.c_str(), z.lastNs / 1000.0, z.meanUs(),
+                 z.percentileUs(0.99));
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+} // namespace profiler
@@ -0,0 +1,92 @@
+#ifndef MAZE_PROFILER_H
+#define MAZE_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Scoped wall-clock timers for the hot paths. Put MAZE_PROFILE_SCOPE("name")
+// at the top of a block to time it. When MAZE_ENABLE_PROFILING is not defined
+// (the default) the macro expands to nothing, so disabled builds pay nothing;
+// the reporting functions below still exist and simply report no zones.
+//
+// Every thread counts into its own block of relaxed atomics that only it
+// writes, so recording takes no locks and snapshot() can read the counters
+// from any thread while they are updated.
+namespace profiler
+{
+
+const int MAX_ZONES = 64;
+// Histogram buckets: bucket b counts durations in [2^b, 2^(b+1)) nanoseconds.
+const int BUCKETS = 40;
+
+struct ZoneStats
+{
+    std::string name;
+    uint64_t count = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+    uint64_t lastNs = 0; // most recent duration on any thread
+    uint64_t buckets[BUCKETS] = {};
+
+    double meanUs() const { return count ? totalNs / 1000.0 / count : 0.0; }
+    // Estimated from the histogram (upper edge of the bucket holding quantile q).
+    double percentileUs(double q) const;
+};
+
+constexpr bool enabled()
+{
+#ifdef MAZE_ENABLE_PROFILING
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Returns the id for name, registering it on first use; -1 once MAX_ZONES
+// names are taken.
+int registerZone(const char *name);
+void record(int zone, uint64_t ns);
+
+// Totals over all threads, in registration order; zones never hit are left out.
+std::vector<ZoneStats> snapshot();
+void reset();
+
+// {"zones": [{"name": ..., "count": ..., "mean_us": ..., ...}]}
+void writeJson(std::ostream &out);
+// Short fixed-width lines for an on-screen overlay, one per zone.
+std::vector<std::string> overlayLines();
+
+class ScopedTimer
+{
+private:
+    int zone;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedTimer(int zone) : zone(zone), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer()
+    {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        record(zone, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+};
+
+} // namespace profiler
+
+#define MAZE_PROFILE_CONCAT_INNER(a, b) a##b
+#define MAZE_PROFILE_CONCAT(a, b) MAZE_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef MAZE_ENABLE_PROFILING
+#define MAZE_PROFILE_SCOPE(name)                                                                      \
+    static const int MAZE_PROFILE_CONCAT(mazeProfileZone, __LINE__) = ::profiler::registerZone(name); \
+    ::profiler::ScopedTimer MAZE_PROFILE_CONCAT(mazeProfileTimer, __LINE__)(MAZE_PROFILE_CONCAT(mazeProfileZone, __LINE__))
+#else
+#define MAZE_PROFILE_SCOPE(name) ((void)0)
+#endif
+
+#endif
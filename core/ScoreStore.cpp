@@ -0,0 +1,482 @@
+#include "ScoreStore.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <numeric>
+#include <tuple>
+
+#include "TopK.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <fcntl.h>
+#include <io.h>
+#include <share.h>
+#include <sys/stat.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+
+struct ScoreLogHeader
+{
+    char magic[4]; // "MZL1"
+    uint32_t version;
+    uint64_t reserved;
+};
+
+struct ScoreLogEntry
+{
+    uint32_t crc; // CRC-32 of the rest of the entry
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t steps;
+    uint64_t seed;
+    double seconds;
+    int64_t timestamp;
+    uint8_t generator;
+    uint8_t difficulty;
+    uint8_t braid;
+    uint8_t reserved[5];
+};
+
+static_assert(sizeof(ScoreLogHeader) == 16, "score log header must stay 16 bytes");
+static_assert(sizeof(ScoreLogEntry) == 48, "score log entries must stay 48 bytes");
+
+const uint32_t SCORE_LOG_VERSION = 1;
+
+uint32_t crc32(const uint8_t *data, size_t n)
+{
+    static const vector<uint32_t> table = [] {
+        vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+            {
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; i++)
+    {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+uint32_t entryCrc(const ScoreLogEntry &entry)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&entry);
+    return crc32(bytes + sizeof(entry.crc), sizeof(entry) - sizeof(entry.crc));
+}
+
+ScoreLogEntry toEntry(const ScoreRecord &record)
+{
+    ScoreLogEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.rows = record.id.rows;
+    entry.cols = record.id.cols;
+    entry.steps = record.steps;
+    entry.seed = record.id.seed;
+    entry.seconds = record.seconds;
+    entry.timestamp = record.timestamp;
+    entry.generator = static_cast<uint8_t>(record.id.generator);
+    entry.difficulty = record.difficulty;
+    entry.braid = record.id.braid;
+    entry.crc = entryCrc(entry);
+    return entry;
+}
+
+ScoreRecord fromEntry(const ScoreLogEntry &entry)
+{
+    ScoreRecord record;
+    record.id.generator = static_cast<Generator>(entry.generator);
+    record.id.rows = static_cast<int>(entry.rows);
+    record.id.cols = static_cast<int>(entry.cols);
+    record.id.seed = entry.seed;
+    record.id.braid = entry.braid;
+    record.difficulty = entry.difficulty;
+    record.steps = entry.steps;
+    record.seconds = entry.seconds;
+    record.timestamp = entry.timestamp;
+    return record;
+}
+
+// Flushes stdio buffers and then the OS cache to the disk.
+bool syncFile(FILE *file)
+{
+    if (fflush(file) != 0)
+    {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Atomically replaces `to` with `from`, making the rename itself durable.
+bool replaceFile(const string &from, const string &to)
+{
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (rename(from.c_str(), to.c_str()) != 0)
+    {
+        return false;
+    }
+    size_t slash = to.find_last_of('/');
+    string dir = slash == string::npos ? "." : to.substr(0, slash + 1);
+    int fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        fsync(fd);
+        ::close(fd);
+    }
+    return true;
+#endif
+}
+
+// Cuts the file at path down to size bytes.
+bool truncateFile(const string &path, long size)
+{
+#ifdef _WIN32
+    int fd = -1;
+    if (_sopen_s(&fd, path.c_str(), _O_RDWR | _O_BINARY, _SH_DENYNO, _S_IREAD | _S_IWRITE) != 0)
+    {
+        return false;
+    }
+    bool ok = _chsize_s(fd, size) == 0 && _commit(fd) == 0;
+    _close(fd);
+    return ok;
+#else
+    int fd = ::open(path.c_str(), O_WRONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool ok = ftruncate(fd, static_cast<off_t>(size)) == 0 && fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#endif
+}
+
+bool onBoard(Board board, const ScoreRecord &record)
+{
+    return board == Board::DIFFICULTY ? record.difficulty != NO_DIFFICULTY : record.id.rows > 0;
+}
+
+tuple<int, int, int, int, uint64_t> boardKey(Board board, const ScoreRecord &record)
+{
+    const MazeId &id = record.id;
+    switch (board)
+    {
+    case Board::DIFFICULTY:
+        return make_tuple(int(record.difficulty), 0, 0, 0, uint64_t(0));
+    case Board::SIZE:
+        return make_tuple(0, int(id.generator) << 8 | id.braid, id.rows, id.cols, uint64_t(0));
+    default:
+        return make_tuple(0, int(id.generator) << 8 | id.braid, id.rows, id.cols, id.seed);
+    }
+}
+
+bool fasterThan(const ScoreRecord &a, const ScoreRecord &b)
+{
+    return a.seconds < b.seconds || (a.seconds == b.seconds && a.timestamp < b.timestamp);
+}
+
+} // namespace
+
+bool onSameBoard(Board board, const ScoreRecord &key, const ScoreRecord &record)
+{
+    return onBoard(board, key) && onBoard(board, record) && boardKey(board, key) == boardKey(board, record);
+}
+
+ScoreStore::ScoreStore(size_t compactEvery, size_t keepPerBoard)
+    : log(nullptr), logSize(0), compactEvery(compactEvery), keepPerBoard(keepPerBoard), appended(0)
+{
+}
+
+ScoreStore::~ScoreStore()
+{
+    close();
+}
+
+bool ScoreStore::open(const string &logPath)
+{
+    close();
+    path = logPath;
+    records.clear();
+    appended = 0;
+
+    bool torn = false;
+    if (!replay(torn))
+    {
+        return false;
+    }
+    // A missing file or a torn tail is rewritten as a clean log.
+    return torn ? compact() : openLog();
+}
+
+void ScoreStore::close()
+{
+    if (log != nullptr)
+    {
+        fclose(log);
+        log = nullptr;
+    }
+}
+
+bool ScoreStore::replay(bool &torn)
+{
+    ifstream in(path, ios::binary | ios::ate);
+    if (!in.good())
+    {
+        torn = true;
+        return true;
+    }
+    streamoff size = in.tellg();
+    if (size < static_cast<streamoff>(sizeof(ScoreLogHeader)))
+    {
+        // Nothing was ever appended after a torn header.
+        torn = true;
+        return true;
+    }
+
+    vector<char> bytes(static_cast<size_t>(size));
+    in.seekg(0);
+    if (!in.read(bytes.data(), size))
+    {
+        return false;
+    }
+
+    ScoreLogHeader header;
+    memcpy(&header, bytes.data(), sizeof(header));
+    if (memcmp(header.magic, "MZL1", 4) != 0 || header.version != SCORE_LOG_VERSION)
+    {
+        return false;
+    }
+
+    // Records have a fixed size, so a corrupt one is skipped without losing
+    // the ones after it; a partial record can only be the last one.
+    size_t offset = sizeof(header);
+    size_t count = (bytes.size() - offset) / sizeof(ScoreLogEntry);
+    records.reserve(count);
+    for (size_t i = 0; i < count; i++, offset += sizeof(ScoreLogEntry))
+    {
+        ScoreLogEntry entry;
+        memcpy(&entry, bytes.data() + offset, sizeof(entry));
+        if (entry.crc == entryCrc(entry))
+        {
+            records.push_back(fromEntry(entry));
+        }
+        else
+        {
+            torn = true;
+        }
+    }
+    torn = torn || offset != bytes.size();
+    return true;
+}
+
+bool ScoreStore::openLog()
+{
+    log = fopen(path.c_str(), "ab");
+    if (log == nullptr)
+    {
+        return false;
+    }
+    // Append mode only moves to the end on the first write.
+    if (fseek(log, 0, SEEK_END) != 0 || (logSize = ftell(log)) < 0)
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+// After a failed append: closes the log, which may still flush part of the
+// record, and cuts it back to the last whole record before reopening it.
+void ScoreStore::dropPartialRecord()
+{
+    close();
+    if (truncateFile(path, logSize))
+    {
+        openLog();
+    }
+}
+
+bool ScoreStore::add(const ScoreRecord &record)
+{
+    if (log == nullptr)
+    {
+        return false;
+    }
+    ScoreLogEntry entry = toEntry(record);
+    if (fwrite(&entry, sizeof(entry), 1, log) != 1 || !syncFile(log))
+    {
+        dropPartialRecord();
+        return false;
+    }
+    logSize += static_cast<long>(sizeof(entry));
+    records.push_back(record);
+
+    // The record is durable whether or not compaction works; a failed one
+    // leaves the old log in place and is tried again on the next add. It only
+    // fails the add if the log could not be reopened, as no later score could
+    // be saved.
+    if (++appended >= compactEvery && !compact())
+    {
+        return log != nullptr;
+    }
+    return true;
+}
+
+bool ScoreStore::compact()
+{
+    // Keep every record that is still among the fastest keepPerBoard on one of
+    // its boards.
+    vector<bool> keep(records.size(), false);
+    vector<size_t> order(records.size());
+    for (Board board : {Board::DIFFICULTY, Board::SIZE, Board::MAZE})
+    {
+        iota(order.begin(), order.end(), size_t(0));
+        sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            auto keyA = boardKey(board, records[a]);
+            auto keyB = boardKey(board, records[b]);
+            return keyA != keyB ? keyA < keyB : fasterThan(records[a], records[b]);
+        });
+        size_t run = 0;
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            const ScoreRecord &record = records[order[i]];
+            run = i > 0 && boardKey(board, records[order[i - 1]]) == boardKey(board, record) ? run + 1 : 0;
+            if (run < keepPerBoard && onBoard(board, record))
+            {
+                keep[order[i]] = true;
+            }
+        }
+    }
+
+    close();
+    string tempPath = path + ".tmp";
+    FILE *out = fopen(tempPath.c_str(), "wb");
+    if (out == nullptr)
+    {
+        openLog();
+        return false;
+    }
+
+    ScoreLogHeader header;
+    memcpy(header.magic, "MZL1", 4);
+    header.version = SCORE_LOG_VERSION;
+    header.reserved = 0;
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+
+    vector<ScoreRecord> kept;
+    for (size_t i = 0; i < records.size() && ok; i++)
+    {
+        if (keep[i])
+        {
+            ScoreLogEntry entry = toEntry(records[i]);
+            ok = fwrite(&entry, sizeof(entry), 1, out) == 1;
+            kept.push_back(records[i]);
+        }
+    }
+    ok = syncFile(out) && ok;
+    ok = fclose(out) == 0 && ok;
+    if (!ok || !replaceFile(tempPath, path))
+    {
+        remove(tempPath.c_str());
+        openLog();
+        return false;
+    }
+
+    records.swap(kept);
+    appended = 0;
+    return openLog();
+}
+
+bool ScoreStore::importLegacy(const string &legacyPath)
+{
+    // Three blocks of "<difficulty> <count>" followed by "<seconds> <date>" lines.
+    ifstream in(legacyPath);
+    if (!in.good())
+    {
+        return false;
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        int difficulty, count;
+        if (!(in >> difficulty >> count))
+        {
+            break;
+        }
+        for (int j = 0; j < count; j++)
+        {
+            ScoreRecord record;
+            record.difficulty = static_cast<uint8_t>(difficulty);
+            in >> record.seconds;
+            in.ignore();
+            string date;
+            getline(in, date);
+
+            struct tm day = {};
+            if (sscanf(date.c_str(), "%d-%d-%d", &day.tm_year, &day.tm_mon, &day.tm_mday) == 3)
+            {
+                day.tm_year -= 1900;
+                day.tm_mon -= 1;
+                day.tm_hour = 12;
+                record.timestamp = static_cast<int64_t>(mktime(&day));
+            }
+            if (!in || !add(record))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+vector<ScoreRecord> ScoreStore::leaderboard(Board board, const ScoreRecord &key, size_t limit) const
+{
+    TopK<ScoreRecord, bool (*)(const ScoreRecord &, const ScoreRecord &)> best(min(limit, records.size()), fasterThan);
+    for (const ScoreRecord &record : records)
+    {
+        if (onSameBoard(board, key, record))
+        {
+            best.insert(record);
+        }
+    }
+    return best.values();
+}
+
+size_t ScoreStore::rank(Board board, const ScoreRecord &key) const
+{
+    size_t faster = 0;
+    for (const ScoreRecord &record : records)
+    {
+        if (onSameBoard(board, key, record) && record.seconds < key.seconds)
+        {
+            faster++;
+        }
+    }
+    return faster;
+}
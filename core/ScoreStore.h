@@ -0,0 +1,92 @@
+#ifndef MAZE_SCORE_STORE_H
+#define MAZE_SCORE_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "MazeId.h"
+
+// Difficulty of scores set on custom sizes and of records that have none.
+const uint8_t NO_DIFFICULTY = 0xFF;
+
+struct ScoreRecord
+{
+    // Maze the score was set on; rows and cols are 0 for scores imported from
+    // the old maze_scores.dat, which did not record the maze.
+    MazeId id;
+    uint8_t difficulty = NO_DIFFICULTY; // Difficulty as an integer
+    uint32_t steps = 0;
+    double seconds = 0.0;
+    int64_t timestamp = 0; // Unix time
+};
+
+// The leaderboards a score can be ranked on: all scores of its difficulty, all
+// scores on mazes of its generator and size, or all scores on its exact maze.
+enum class Board
+{
+    DIFFICULTY,
+    SIZE,
+    MAZE
+};
+
+// True if record is on the same `board` as key. Records without a difficulty
+// (or without a maze, for SIZE and MAZE) are on no board of that kind.
+bool onSameBoard(Board board, const ScoreRecord &key, const ScoreRecord &record);
+
+// Crash-safe score storage. Every score is appended to a log as a fixed-size
+// record with its own CRC-32 and synced to disk before add() returns, so a
+// crash can at worst lose the record being written. open() replays the log
+// and drops torn or corrupt records.
+//
+// Every compactEvery appends (and after a torn tail was found) the log is
+// compacted: the records still in the top keepPerBoard of one of their boards
+// are written to a temporary file, synced, and renamed over the log, so the
+// log on disk is always either the old one or the new one.
+class ScoreStore
+{
+private:
+    std::string path;
+    std::FILE *log;
+    long logSize; // bytes of whole records in the log
+    std::vector<ScoreRecord> records;
+    size_t compactEvery;
+    size_t keepPerBoard;
+    size_t appended;
+
+    bool replay(bool &torn);
+    bool openLog();
+    void dropPartialRecord();
+
+public:
+    ScoreStore(size_t compactEvery = 256, size_t keepPerBoard = 100);
+    ~ScoreStore();
+    ScoreStore(const ScoreStore &) = delete;
+    ScoreStore &operator=(const ScoreStore &) = delete;
+
+    // Opens (creating if needed) the log at logPath and loads its scores.
+    // Returns false on I/O failure or if the file is not a score log.
+    bool open(const std::string &logPath);
+    void close();
+
+    // Appends one score. Returns false if it could not be made durable; the
+    // log is then cut back to the records before it, or closed if that fails
+    // too, so later appends never land after a partial record.
+    bool add(const ScoreRecord &record);
+    bool compact();
+
+    // Adds the scores from an old maze_scores.dat text file. Returns false if
+    // it cannot be read.
+    bool importLegacy(const std::string &legacyPath);
+
+    // Fastest scores on the board key is on, at most limit of them.
+    std::vector<ScoreRecord> leaderboard(Board board, const ScoreRecord &key, size_t limit) const;
+    // Number of stored scores on that board faster than key.
+    size_t rank(Board board, const ScoreRecord &key) const;
+
+    size_t size() const { return records.size(); }
+};
+
+#endif
@@ -0,0 +1,606 @@
+#include "Solver.h"
+
+#include "BitGrid.h"
+#include "ParallelBfs.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+using namespace std;
+using namespace chrono;
+
+namespace
+{
+
+const int OPPOSITE[] = {Grid::DOWN, Grid::UP, Grid::RIGHT, Grid::LEFT};
+
+inline bool isOpen(const Grid &grid, size_t idx)
+{
+    return grid.kind(idx) != Grid::KIND_WALL;
+}
+
+// Sizes a per-cell distance buffer for the grid. Solvers reset only the entries
+// they touched after each search, so the full fill happens once per grid size.
+void prepareDistances(vector<int32_t> &dist, const Grid &grid)
+{
+    if (dist.size() != grid.size())
+    {
+        dist.assign(grid.size(), -1);
+    }
+}
+
+// Appends the cells from `start` down to the distance-0 source, always stepping
+// to a neighbour one closer. The outer ring is wall, so steps stay in bounds.
+void walkDown(const Grid &grid, const vector<int32_t> &dist, size_t start, vector<size_t> &cells)
+{
+    size_t current = start;
+    cells.push_back(current);
+    while (dist[current] > 0)
+    {
+        int32_t want = dist[current] - 1;
+        for (int dir = 0; dir < 4; dir++)
+        {
+            size_t next = grid.step(current, dir);
+            if (dist[next] == want)
+            {
+                current = next;
+                break;
+            }
+        }
+        cells.push_back(current);
+    }
+}
+
+// Plain breadth-first search over the cells accepted by `passable`. Leaves dist
+// clean (all -1) on return.
+template <typename Passable>
+bool bfsPath(const Grid &grid, size_t from, size_t to, vector<int32_t> &dist, vector<size_t> &queue,
+             vector<size_t> &cells, long long &nodesExpanded, Passable passable)
+{
+    queue.clear();
+    queue.push_back(from);
+    dist[from] = 0;
+
+    bool found = false;
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        size_t current = queue[head];
+        nodesExpanded++;
+
+        if (current == to)
+        {
+            found = true;
+            break;
+        }
+
+        int32_t nextDistance = dist[current] + 1;
+        for (int dir = 0; dir < 4; dir++)
+        {
+            size_t next = grid.step(current, dir);
+            if (dist[next] < 0 && passable(next))
+            {
+                dist[next] = nextDistance;
+                queue.push_back(next);
+            }
+        }
+    }
+
+    if (found)
+    {
+        walkDown(grid, dist, to, cells);
+        reverse(cells.begin(), cells.end());
+    }
+
+    for (size_t idx : queue)
+    {
+        dist[idx] = -1;
+    }
+    return found;
+}
+
+class BfsSolver : public Solver
+{
+private:
+    vector<int32_t> dist;
+    vector<size_t> queue;
+
+protected:
+    bool search(const Grid &grid, size_t from, size_t to, vector<size_t> &cells, long long &nodesExpanded) override
+    {
+        prepareDistances(dist, grid);
+        return bfsPath(grid, from, to, dist, queue, cells, nodesExpanded,
+                       [&grid](size_t idx) { return isOpen(grid, idx); });
+    }
+
+public:
+    const char *name() const override { return solverName(SolverKind::BFS); }
+};
+
+// A* with the Manhattan distance to the target as heuristic. Ties on f are
+// broken towards the larger g, which keeps the search hugging the goal.
+class AStarSolver : public Solver
+{
+private:
+    struct Entry
+    {
+        int32_t f;
+        int32_t g;
+        size_t idx;
+
+        // Inverted for std::push_heap, which builds a max-heap.
+        bool operator<(const Entry &other) const
+        {
+            return f != other.f ? f > other.f : g < other.g;
+        }
+    };
+
+    vector<int32_t> g;
+    vector<Entry> open;
+    vector<size_t> touched;
+
+protected:
+    bool search(const Grid &grid, size_t from, size_t to, vector<size_t> &cells, long long &nodesExpanded) override
+    {
+        prepareDistances(g, grid);
+
+        int targetRow = grid.rowOf(to);
+        int targetCol = grid.colOf(to);
+        auto heuristic = [&](size_t idx) {
+            return abs(grid.rowOf(idx) - targetRow) + abs(grid.colOf(idx) - targetCol);
+        };
+
+        open.clear();
+        touched.clear();
+        g[from] = 0;
+        touched.push_back(from);
+        open.push_back({heuristic(from), 0, from});
+
+        bool found = false;
+        while (!open.empty())
+        {
+            pop_heap(open.begin(), open.end());
+            Entry entry = open.back();
+            open.pop_back();
+
+            if (entry.g != g[entry.idx])
+            {
+                continue; // stale entry, a shorter route was found later
+            }
+            nodesExpanded++;
+
+            if (entry.idx == to)
+            {
+                found = true;
+                break;
+            }
+
+            int32_t nextG = entry.g + 1;
+            for (int dir = 0; dir < 4; dir++)
+            {
+                size_t next = grid.step(entry.idx, dir);
+                if (!isOpen(grid, next) || (g[next] >= 0 && g[next] <= nextG))
+                {
+                    continue;
+                }
+                if (g[next] < 0)
+                {
+                    touched.push_back(next);
+                }
+                g[next] = nextG;
+                open.push_back({nextG + heuristic(next), nextG, next});
+                push_heap(open.begin(), open.end());
+            }
+        }
+
+        // With a consistent heuristic, a neighbour whose g is exactly one less
+        // always lies on a shortest path, so the gradient walk works on g too.
+        if (found)
+        {
+            walkDown(grid, g, to, cells);
+            reverse(cells.begin(), cells.end());
+        }
+
+        for (size_t idx : touched)
+        {
+            g[idx] = -1;
+        }
+        return found;
+    }
+
+public:
+    const char *name() const override { return solverName(SolverKind::ASTAR); }
+};
+
+// Breadth-first search from both ends at once, always growing the smaller
+// frontier by one full level. The level in which the frontiers first touch is
+// finished before stopping, which guarantees the shortest meeting point.
+class BidirectionalBfsSolver : public Solver
+{
+private:
+    vector<int32_t> dist[2];
+    vector<size_t> frontier[2];
+    vector<size_t> visited[2];
+    vector<size_t> next;
+
+protected:
+    bool search(const Grid &grid, size_t from, size_t to, vector<size_t> &cells, long long &nodesExpanded) override
+    {
+        if (from == to)
+        {
+            cells.push_back(from);
+            nodesExpanded++;
+            return true;
+        }
+
+        size_t source[2] = {from, to};
+        for (int side = 0; side < 2; side++)
+        {
+            prepareDistances(dist[side], grid);
+            frontier[side].assign(1, source[side]);
+            visited[side].assign(1, source[side]);
+            dist[side][source[side]] = 0;
+        }
+
+        long long best = -1;
+        size_t meet[2] = {0, 0};
+
+        while (best < 0 && !frontier[0].empty() && !frontier[1].empty())
+        {
+            int side = frontier[0].size() <= frontier[1].size() ? 0 : 1;
+            vector<int32_t> &mine = dist[side];
+            const vector<int32_t> &theirs = dist[1 - side];
+
+            next.clear();
+            for (size_t current : frontier[side])
+            {
+                nodesExpanded++;
+                for (int dir = 0; dir < 4; dir++)
+                {
+                    size_t n = grid.step(current, dir);
+                    if (!isOpen(grid, n))
+                    {
+                        continue;
+                    }
+                    if (theirs[n] >= 0)
+                    {
+                        long long length = static_cast<long long>(mine[current]) + 1 + theirs[n];
+                        if (best < 0 || length < best)
+                        {
+                            best = length;
+                            meet[side] = current;
+                            meet[1 - side] = n;
+                        }
+                    }
+                    if (mine[n] < 0)
+                    {
+                        mine[n] = mine[current] + 1;
+                        next.push_back(n);
+                        visited[side].push_back(n);
+                    }
+                }
+            }
+            frontier[side].swap(next);
+        }
+
+        if (best >= 0)
+        {
+            walkDown(grid, dist[0], meet[0], cells);
+            reverse(cells.begin(), cells.end());
+            walkDown(grid, dist[1], meet[1], cells);
+        }
+
+        for (int side = 0; side < 2; side++)
+        {
+            for (size_t idx : visited[side])
+            {
+                dist[side][idx] = -1;
+            }
+        }
+        return best >= 0;
+    }
+
+public:
+    const char *name() const override { return solverName(SolverKind::BIDIRECTIONAL_BFS); }
+};
+
+// Dead-end filling: repeatedly seal open cells with at most one open neighbour
+// (other than the endpoints). In a perfect maze only the solution survives; in
+// a maze with loops the survivors still contain every shortest path, so a BFS
+// over them finishes the job.
+class DeadEndFillSolver : public Solver
+{
+private:
+    vector<uint8_t> degree;
+    vector<uint8_t> filled;
+    vector<size_t> pending;
+    vector<int32_t> dist;
+    vector<size_t> queue;
+
+protected:
+    bool search(const Grid &grid, size_t from, size_t to, vector<size_t> &cells, long long &nodesExpanded) override
+    {
+        degree.assign(grid.size(), 0);
+        filled.assign(grid.size(), 0);
+        pending.clear();
+
+        for (int r = 1; r < grid.getRows() - 1; r++)
+        {
+            for (int c = 1; c < grid.getCols() - 1; c++)
+            {
+                size_t idx = grid.index(r, c);
+                if (!isOpen(grid, idx))
+                {
+                    continue;
+                }
+                uint8_t open = 0;
+                for (int dir = 0; dir < 4; dir++)
+                {
+                    open += isOpen(grid, grid.step(idx, dir));
+                }
+                degree[idx] = open;
+                if (open <= 1 && idx != from && idx != to)
+                {
+                    pending.push_back(idx);
+                }
+            }
+        }
+
+        while (!pending.empty())
+        {
+            size_t current = pending.back();
+            pending.pop_back();
+            if (filled[current])
+            {
+                continue;
+            }
+            filled[current] = 1;
+            nodesExpanded++;
+
+            for (int dir = 0; dir < 4; dir++)
+            {
+                size_t n = grid.step(current, dir);
+                if (isOpen(grid, n) && !filled[n] && --degree[n] <= 1 && n != from && n != to)
+                {
+                    pending.push_back(n);
+                }
+            }
+        }
+
+        prepareDistances(dist, grid);
+        return bfsPath(grid, from, to, dist, queue, cells, nodesExpanded,
+                       [&](size_t idx) { return isOpen(grid, idx) && !filled[idx]; });
+    }
+
+public:
+    const char *name() const override { return solverName(SolverKind::DEAD_END_FILL); }
+};
+
+// Right-hand wall follower with loop erasure: whenever the walk returns to a
+// cell already on the path, the loop in between is cut off. In a perfect maze
+// that leaves exactly the unique (and therefore shortest) path; in a maze with
+// loops the result is a simple path but not necessarily the shortest one, and
+// when the wall it starts on is a free-standing island it finds nothing.
+class WallFollowerSolver : public Solver
+{
+private:
+    vector<int32_t> position;
+
+protected:
+    bool search(const Grid &grid, size_t from, size_t to, vector<size_t> &cells, long long &nodesExpanded) override
+    {
+        static const int RIGHT_OF[] = {Grid::RIGHT, Grid::LEFT, Grid::UP, Grid::DOWN};
+        static const int LEFT_OF[] = {Grid::LEFT, Grid::RIGHT, Grid::DOWN, Grid::UP};
+
+        prepareDistances(position, grid);
+
+        size_t current = from;
+        int heading = Grid::UP;
+        cells.push_back(current);
+        position[current] = 0;
+
+        // Following one wall visits every cell at most four times before it
+        // cycles, so anything beyond that means `to` is not on this wall.
+        long long limit = 4 * static_cast<long long>(grid.size()) + 4;
+        bool found = current == to;
+
+        while (!found && nodesExpanded < limit)
+        {
+            int tries[] = {RIGHT_OF[heading], heading, LEFT_OF[heading], OPPOSITE[heading]};
+            for (int dir : tries)
+            {
+                size_t n = grid.step(current, dir);
+                if (isOpen(grid, n))
+                {
+                    heading = dir;
+                    current = n;
+                    break;
+                }
+            }
+            nodesExpanded++;
+
+            if (position[current] >= 0)
+            {
+                size_t keep = position[current] + 1;
+                for (size_t i = keep; i < cells.size(); i++)
+                {
+                    position[cells[i]] = -1;
+                }
+                cells.resize(keep);
+            }
+            else
+            {
+                position[current] = static_cast<int32_t>(cells.size());
+                cells.push_back(current);
+            }
+            found = current == to;
+        }
+
+        for (size_t idx : cells)
+        {
+            position[idx] = -1;
+        }
+        if (!found)
+        {
+            cells.clear();
+        }
+        return found;
+    }
+
+public:
+    const char *name() const override { return solverName(SolverKind::WALL_FOLLOWER); }
+    bool isShortest() const override { return false; }
+};
+
+// Breadth-first search on all hardware threads, see ParallelBfs. The thread
+// pool is only started on the first search.
+class ParallelBfsSolver : public Solver
+{
+private:
+    unique_ptr<ParallelBfs> bfs;
+    vector<int32_t> dist;
+
+protected:
+    bool search(const Grid &grid, size_t from, size_t to, vector<size_t> &cells, long long &nodesExpanded) override
+    {
+        if (!bfs)
+        {
+            bfs = make_unique<ParallelBfs>();
+        }
+        bfs->run(grid, from, dist, to, nodesExpanded);
+        if (dist[to] < 0)
+        {
+            return false;
+        }
+        walkDown(grid, dist, to, cells);
+        reverse(cells.begin(), cells.end());
+        return true;
+    }
+
+public:
+    const char *name() const override { return solverName(SolverKind::PARALLEL_BFS); }
+};
+
+// Word-parallel BFS on a one-bit-per-cell copy of the grid, see BitBfs. The
+// copy is refreshed on every search, which the solve time includes.
+class BitBfsSolver : public Solver
+{
+private:
+    BitGrid bits;
+    BitBfs bfs;
+    vector<pair<int, int>> path;
+
+protected:
+    bool search(const Grid &grid, size_t from, size_t to, vector<size_t> &cells, long long &nodesExpanded) override
+    {
+        bits.fromGrid(grid);
+        if (!bfs.solve(bits.view(), {grid.rowOf(from), grid.colOf(from)}, {grid.rowOf(to), grid.colOf(to)}, path,
+                       nodesExpanded))
+        {
+            return false;
+        }
+        for (const auto &cell : path)
+        {
+            cells.push_back(grid.index(cell.first, cell.second));
+        }
+        return true;
+    }
+
+public:
+    const char *name() const override { return solverName(SolverKind::BIT_BFS); }
+};
+
+} // namespace
+
+bool Solver::solve(const Grid &grid, pair<int, int> from, pair<int, int> to, vector<pair<int, int>> &path,
+                   SolveStats &stats)
+{
+    path.clear();
+    stats = SolveStats();
+
+    if (!grid.inBounds(from.first, from.second) || !grid.inBounds(to.first, to.second))
+    {
+        return false;
+    }
+    size_t start = grid.index(from.first, from.second);
+    size_t target = grid.index(to.first, to.second);
+    if (!isOpen(grid, start) || !isOpen(grid, target))
+    {
+        return false;
+    }
+
+    cells.clear();
+    auto t0 = high_resolution_clock::now();
+    bool found = search(grid, start, target, cells, stats.nodesExpanded);
+    stats.wallMs = duration<double, milli>(high_resolution_clock::now() - t0).count();
+
+    path.reserve(cells.size());
+    for (size_t idx : cells)
+    {
+        path.push_back({grid.rowOf(idx), grid.colOf(idx)});
+    }
+    return found;
+}
+
+unique_ptr<Solver> makeSolver(SolverKind kind)
+{
+    switch (kind)
+    {
+    case SolverKind::ASTAR:
+        return make_unique<AStarSolver>();
+    case SolverKind::BIDIRECTIONAL_BFS:
+        return make_unique<BidirectionalBfsSolver>();
+    case SolverKind::DEAD_END_FILL:
+        return make_unique<DeadEndFillSolver>();
+    case SolverKind::WALL_FOLLOWER:
+        return make_unique<WallFollowerSolver>();
+    case SolverKind::PARALLEL_BFS:
+        return make_unique<ParallelBfsSolver>();
+    case SolverKind::BIT_BFS:
+        return make_unique<BitBfsSolver>();
+    default:
+        return make_unique<BfsSolver>();
+    }
+}
+
+const char *solverName(SolverKind kind)
+{
+    switch (kind)
+    {
+    case SolverKind::ASTAR:
+        return "astar";
+    case SolverKind::BIDIRECTIONAL_BFS:
+        return "bidirectional";
+    case SolverKind::DEAD_END_FILL:
+        return "deadend";
+    case SolverKind::WALL_FOLLOWER:
+        return "wallfollower";
+    case SolverKind::PARALLEL_BFS:
+        return "parallelbfs";
+    case SolverKind::BIT_BFS:
+        return "bitbfs";
+    default:
+        return "bfs";
+    }
+}
+
+const vector<SolverKind> &allSolverKinds()
+{
+    static const vector<SolverKind> kinds = {SolverKind::BFS, SolverKind::ASTAR, SolverKind::BIDIRECTIONAL_BFS,
+                                             SolverKind::DEAD_END_FILL, SolverKind::WALL_FOLLOWER,
+                                             SolverKind::PARALLEL_BFS, SolverKind::BIT_BFS};
+    return kinds;
+}
+
+bool parseSolverKind(const string &name, SolverKind &kind)
+{
+    for (SolverKind k : allSolverKinds())
+    {
+        if (name == solverName(k))
+        {
+            kind = k;
+            return true;
+        }
+    }
+    return false;
+}
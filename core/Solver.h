@@ -0,0 +1,60 @@
+#ifndef MAZE_SOLVER_H
+#define MAZE_SOLVER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Grid.h"
+
+enum class SolverKind
+{
+    BFS,
+    ASTAR,
+    BIDIRECTIONAL_BFS,
+    DEAD_END_FILL,
+    WALL_FOLLOWER,
+    PARALLEL_BFS,
+    BIT_BFS
+};
+
+struct SolveStats
+{
+    long long nodesExpanded = 0;
+    double wallMs = 0.0;
+};
+
+// A path search from one open cell to another on a Grid. Every solver uses the
+// same contract: on success path holds the cells from `from` to `to`, both
+// included, each adjacent to the next; on failure path is empty.
+//
+// Solvers keep their scratch buffers between calls, so reusing one instance
+// for many searches avoids reallocating them. Solvers never modify the grid.
+class Solver
+{
+private:
+    std::vector<size_t> cells;
+
+protected:
+    virtual bool search(const Grid &grid, size_t from, size_t to, std::vector<size_t> &cells,
+                        long long &nodesExpanded) = 0;
+
+public:
+    virtual ~Solver() = default;
+    virtual const char *name() const = 0;
+
+    // True when the solver always finds a shortest path, also in mazes with loops.
+    virtual bool isShortest() const { return true; }
+
+    bool solve(const Grid &grid, std::pair<int, int> from, std::pair<int, int> to,
+               std::vector<std::pair<int, int>> &path, SolveStats &stats);
+};
+
+std::unique_ptr<Solver> makeSolver(SolverKind kind);
+const char *solverName(SolverKind kind);
+const std::vector<SolverKind> &allSolverKinds();
+bool parseSolverKind(const std::string &name, SolverKind &kind);
+
+#endif
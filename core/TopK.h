@@ -0,0 +1,77 @@
+#ifndef MAZE_TOP_K_H
+#define MAZE_TOP_K_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// The best `capacity` values seen so far, kept sorted best first by Compare
+// (a strict weak order where "less" means "better", e.g. a faster time). Ties
+// are stable: a value ranks behind the equal values inserted before it.
+//
+// Storage is a sorted vector reserved up front, so it never reallocates. The
+// position is found by binary search (O(log K) comparisons); making room moves
+// the worse entries along by one, which for leaderboard-sized K is a single
+// short memmove and beats a heap that would have to be sorted to display.
+template <typename T, typename Compare = std::less<T>>
+class TopK
+{
+private:
+    size_t k;
+    std::vector<T> items;
+    Compare better;
+
+public:
+    explicit TopK(size_t capacity, Compare compare = Compare()) : k(capacity), better(compare)
+    {
+        items.reserve(capacity);
+    }
+
+    // Place (0 = best) a new value would take, which may be >= capacity().
+    // Counts the stored values that are better than or equal to it.
+    size_t rank(const T &value) const
+    {
+        return std::upper_bound(items.begin(), items.end(), value, better) - items.begin();
+    }
+
+    bool qualifies(const T &value) const { return rank(value) < k; }
+
+    // Inserts value if it makes the cut, dropping the worst entry when full.
+    // Returns its place, or capacity() if it was not kept.
+    size_t insert(const T &value)
+    {
+        // Most submissions to a full board miss it; one comparison tells.
+        if (items.size() == k && (k == 0 || !better(value, items.back())))
+        {
+            return k;
+        }
+        size_t place = rank(value);
+        if (place >= k)
+        {
+            return k;
+        }
+        if (items.size() == k)
+        {
+            items.pop_back();
+        }
+        items.insert(items.begin() + place, value);
+        return place;
+    }
+
+    void clear() { items.clear(); }
+
+    size_t size() const { return items.size(); }
+    size_t capacity() const { return k; }
+    bool empty() const { return items.empty(); }
+    bool full() const { return items.size() == k; }
+
+    const T &operator[](size_t i) const { return items[i]; }
+    const T &best() const { return items.front(); }
+    const T &worst() const { return items.back(); }
+    typename std::vector<T>::const_iterator begin() const { return items.begin(); }
+    typename std::vector<T>::const_iterator end() const { return items.end(); }
+    const std::vector<T> &values() const { return items; }
+};
+
+#endif
@@ -0,0 +1,142 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+
+using namespace std;
+
+WorkStealingPool::WorkStealingPool(unsigned threads)
+    : task(nullptr), invoke(nullptr), batch(0), running(0), stopping(false)
+{
+    if (threads == 0)
+    {
+        threads = max(1u, thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threads; i++)
+    {
+        ranges.push_back(make_unique<Range>());
+    }
+    for (unsigned i = 1; i < threads; i++)
+    {
+        this->threads.emplace_back(&WorkStealingPool::threadMain, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (thread &t : threads)
+    {
+        t.join();
+    }
+}
+
+bool WorkStealingPool::takeOwn(unsigned worker, size_t &taskNumber)
+{
+    Range &own = *ranges[worker];
+    lock_guard<mutex> guard(own.lock);
+    if (own.begin == own.end)
+    {
+        return false;
+    }
+    taskNumber = own.begin++;
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned worker)
+{
+    unsigned n = size();
+    for (unsigned k = 1; k < n; k++)
+    {
+        Range &victim = *ranges[(worker + k) % n];
+        size_t begin, end;
+        {
+            lock_guard<mutex> guard(victim.lock);
+            size_t left = victim.end - victim.begin;
+            if (left == 0)
+            {
+                continue;
+            }
+            begin = victim.begin + left / 2;
+            end = victim.end;
+            victim.end = begin;
+        }
+
+        // Our own range is empty here, so the stolen half simply replaces it
+        // and can in turn be stolen from by others.
+        Range &own = *ranges[worker];
+        lock_guard<mutex> guard(own.lock);
+        own.begin = begin;
+        own.end = end;
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::work(unsigned worker)
+{
+    size_t taskNumber;
+    do
+    {
+        while (takeOwn(worker, taskNumber))
+        {
+            invoke(task, worker, taskNumber);
+        }
+    } while (steal(worker));
+}
+
+void WorkStealingPool::threadMain(unsigned worker)
+{
+    unsigned long long seen = 0;
+    while (true)
+    {
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [&] { return stopping || batch != seen; });
+            if (stopping)
+            {
+                return;
+            }
+            seen = batch;
+        }
+
+        work(worker);
+
+        lock_guard<mutex> guard(lock);
+        if (--running == 0)
+        {
+            finished.notify_one();
+        }
+    }
+}
+
+void WorkStealingPool::runBatch(size_t count, void *fn, Invoke fnInvoke)
+{
+    unsigned n = size();
+    for (unsigned i = 0; i < n; i++)
+    {
+        Range &range = *ranges[i];
+        lock_guard<mutex> guard(range.lock);
+        range.begin = count * i / n;
+        range.end = count * (i + 1) / n;
+    }
+
+    {
+        lock_guard<mutex> guard(lock);
+        task = fn;
+        invoke = fnInvoke;
+        running = n;
+        batch++;
+    }
+    wake.notify_all();
+
+    work(0);
+
+    unique_lock<mutex> guard(lock);
+    running--;
+    finished.wait(guard, [&] { return running == 0; });
+    task = nullptr;
+}
@@ -0,0 +1,73 @@
+#ifndef MAZE_WORK_STEALING_POOL_H
+#define MAZE_WORK_STEALING_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of worker threads that run batches of independent, numbered tasks.
+// Each batch is split into one contiguous range of task numbers per worker.
+// A worker takes tasks from the front of its own range; once that is empty it
+// steals the back half of another worker's range, so uneven task costs (mixed
+// maze sizes, say) still keep every thread busy until the batch is done.
+//
+// The calling thread acts as worker 0, so a pool of one thread runs the batch
+// inline without any synchronisation overhead beyond the range locks.
+class WorkStealingPool
+{
+private:
+    // The task of the running batch, referred to rather than copied: wrapping
+    // it in a std::function could allocate on every batch.
+    using Invoke = void (*)(void *task, unsigned worker, size_t taskNumber);
+
+    struct Range
+    {
+        std::mutex lock;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    std::vector<std::unique_ptr<Range>> ranges;
+    std::vector<std::thread> threads;
+
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    void *task;
+    Invoke invoke;
+    unsigned long long batch;
+    unsigned running;
+    bool stopping;
+
+    bool takeOwn(unsigned worker, size_t &taskNumber);
+    bool steal(unsigned worker);
+    void work(unsigned worker);
+    void threadMain(unsigned worker);
+    void runBatch(size_t count, void *task, Invoke invoke);
+
+public:
+    // threads == 0 picks std::thread::hardware_concurrency().
+    explicit WorkStealingPool(unsigned threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(ranges.size()); }
+
+    // Runs task(worker, taskNumber) for every number in [0, count) and returns
+    // once all are done; worker is in [0, size()).
+    template <typename Task>
+    void run(size_t count, Task &&task)
+    {
+        using Fn = std::remove_reference_t<Task>;
+        runBatch(count, const_cast<void *>(static_cast<const void *>(&task)),
+                 [](void *fn, unsigned worker, size_t taskNumber) { (*static_cast<Fn *>(fn))(worker, taskNumber); });
+    }
+};
+
+#endif
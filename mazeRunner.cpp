@@ -1,47 +1,26 @@
 #include <iostream>
 #include <vector>
-#include <queue>
 #include <utility>
-#include <stack>
 #include <ctime>
 #include <algorithm>
-#include <random>
+#define NOMINMAX
 #include <windows.h>
 #include <conio.h>
 #include <fstream>
 #include <iomanip>
 #include <string>
 #include <chrono>
+#include <sstream>
+
+#include "core/FrameBuffer.h"
+#include "core/InputLog.h"
+#include "core/Maze.h"
+#include "core/Profiler.h"
+#include "core/ScoreStore.h"
 
 using namespace std;
 using namespace chrono;
 
-enum class Difficulty
-{
-    EASY,
-    MEDIUM,
-    HARD
-};
-enum class ConsoleColor
-{
-    BLACK = 0,
-    BLUE = 1,
-    GREEN = 2,
-    CYAN = 3,
-    RED = 4,
-    MAGENTA = 5,
-    BROWN = 6,
-    LIGHTGRAY = 7,
-    DARKGRAY = 8,
-    LIGHTBLUE = 9,
-    LIGHTGREEN = 10,
-    LIGHTCYAN = 11,
-    LIGHTRED = 12,
-    LIGHTMAGENTA = 13,
-    YELLOW = 14,
-    WHITE = 15
-};
-
 class Console
 {
 private:
@@ -97,6 +76,14 @@ public:
         SetConsoleCursorPosition(hConsole, coord);
     }
 
+    // Writes one run of same-coloured text, as handed out by FrameBuffer::present.
+    void write(int x, int y, const char *text, int length, ConsoleColor color)
+    {
+        gotoXY(x, y);
+        setColor(color);
+        cout.write(text, length);
+    }
+
     void printCentered(const string &text, int yOffset = 0)
     {
         CONSOLE_SCREEN_BUFFER_INFO csbi;
@@ -139,111 +126,152 @@ public:
     }
 };
 
-struct HighScore
+// Keyboard input from the console, stamped with the time since the game started.
+class ConsoleInput : public InputSource
 {
-    double time;
-    string date;
-    bool operator<(const HighScore &other) const
+private:
+    steady_clock::time_point started;
+
+    static Command readCommand()
+    {
+        int key = _getch();
+        if (key == 0 || key == 0xE0)
+        {
+            // Arrow keys arrive as a prefix byte and a scan code.
+            switch (_getch())
+            {
+            case 72:
+                return Command::MOVE_UP;
+            case 75:
+                return Command::MOVE_LEFT;
+            case 80:
+                return Command::MOVE_DOWN;
+            case 77:
+                return Command::MOVE_RIGHT;
+            default:
+                return Command::NONE;
+            }
+        }
+
+        switch (tolower(key))
+        {
+        case 'w':
+            return Command::MOVE_UP;
+        case 'a':
+            return Command::MOVE_LEFT;
+        case 's':
+            return Command::MOVE_DOWN;
+        case 'd':
+            return Command::MOVE_RIGHT;
+        case 'f':
+            return Command::TOGGLE_SOLUTION;
+        case 'c':
+            return Command::CLEAR_TRAIL;
+        case 'r':
+            return Command::RESTART;
+        case 'h':
+            return Command::HIGH_SCORES;
+        case 'p':
+            return Command::PROFILE;
+        case 'q':
+            return Command::QUIT;
+        default:
+            return Command::NONE;
+        }
+    }
+
+public:
+    ConsoleInput() : started(steady_clock::now()) {}
+
+    uint32_t elapsedMs() const
     {
-        return time < other.time;
+        return static_cast<uint32_t>(duration_cast<milliseconds>(steady_clock::now() - started).count());
+    }
+
+    bool next(InputEvent &event) override
+    {
+        event.command = readCommand();
+        event.atMs = elapsedMs();
+        return true;
     }
 };
 
 class ScoreManager
 {
 private:
-    vector<HighScore> highScores[3];
+    ScoreStore store;
     const string difficultyNames[3] = {"Easy", "Medium", "Hard"};
     const int MAX_HIGH_SCORES = 5;
+    const string SCORE_LOG = "maze_scores.log";
+    const string LEGACY_SCORES = "maze_scores.dat";
     Console &console;
 
-public:
-    ScoreManager(Console &con) : console(con)
+    static ScoreRecord difficultyKey(int difficulty)
     {
-        initHighScores();
+        ScoreRecord key;
+        key.difficulty = static_cast<uint8_t>(difficulty);
+        return key;
     }
 
-    void initHighScores()
+    static string formatDate(int64_t timestamp)
     {
-        ifstream inFile("maze_scores.dat");
-        if (!inFile.good())
-        {
-            for (int i = 0; i < 3; i++)
-            {
-                highScores[i].clear();
-            }
-
-            ofstream outFile("maze_scores.dat");
-            for (int i = 0; i < 3; i++)
-            {
-                outFile << i << " 0" << endl;
-            }
-            outFile.close();
-        }
-        else
-        {
-            for (int i = 0; i < 3; i++)
-            {
-                highScores[i].clear();
+        time_t when = static_cast<time_t>(timestamp);
+        struct tm timeinfo;
+        localtime_s(&timeinfo, &when);
 
-                int difficulty, numScores;
-                inFile >> difficulty >> numScores;
+        char buffer[80];
+        strftime(buffer, sizeof(buffer), "%Y-%m-%d", &timeinfo);
+        return buffer;
+    }
 
-                for (int j = 0; j < numScores; j++)
-                {
-                    HighScore score;
-                    inFile >> score.time;
-                    inFile.ignore();
-                    getline(inFile, score.date);
-                    highScores[i].push_back(score);
-                }
-            }
-            inFile.close();
-        }
+public:
+    ScoreManager(Console &con) : console(con)
+    {
+        initHighScores();
     }
 
-    void saveHighScores()
+    void initHighScores()
     {
-        ofstream outFile("maze_scores.dat");
-        for (int i = 0; i < 3; i++)
+        // Scores from the old text file are carried over once, when the log
+        // is first created.
+        bool firstRun = !ifstream(SCORE_LOG).good();
+        store.open(SCORE_LOG);
+        if (firstRun)
         {
-            outFile << i << " " << highScores[i].size() << endl;
-            for (const auto &score : highScores[i])
-            {
-                outFile << score.time << " " << score.date << endl;
-            }
+            store.importLegacy(LEGACY_SCORES);
         }
-        outFile.close();
     }
 
-    bool addHighScore(Difficulty diff, double time)
+    // Records a finished game. Returns false if it could not be saved;
+    // otherwise isHighScore tells whether it made the top scores of its
+    // difficulty.
+    bool addHighScore(Difficulty diff, const Maze &maze, double time, bool &isHighScore)
     {
-        time_t now = system_clock::to_time_t(system_clock::now());
-        struct tm timeinfo;
-        localtime_s(&timeinfo, &now);
+        ScoreRecord score;
+        score.id = maze.getId();
+        score.difficulty = static_cast<uint8_t>(diff);
+        score.steps = maze.getPathLength();
+        score.seconds = time;
+        score.timestamp = static_cast<int64_t>(system_clock::to_time_t(system_clock::now()));
 
-        char buffer[80];
-        strftime(buffer, sizeof(buffer), "%Y-%m-%d", &timeinfo);
-        string date(buffer);
-
-        HighScore newScore = {time, date};
-        int diffIndex = static_cast<int>(diff);
-
-        if (highScores[diffIndex].size() < MAX_HIGH_SCORES || time < highScores[diffIndex].back().time)
+        isHighScore = false;
+        if (!store.add(score))
         {
-            highScores[diffIndex].push_back(newScore);
-            sort(highScores[diffIndex].begin(), highScores[diffIndex].end());
-
-            if (highScores[diffIndex].size() > MAX_HIGH_SCORES)
-            {
-                highScores[diffIndex].resize(MAX_HIGH_SCORES);
-            }
-
-            saveHighScores();
-            return true;
+            return false;
         }
+        isHighScore = store.rank(Board::DIFFICULTY, score) < static_cast<size_t>(MAX_HIGH_SCORES);
+        return true;
+    }
 
-        return false;
+    // Fastest time on exactly this maze, and how many players beat `time` on it.
+    double bestOnMaze(const Maze &maze, double time, size_t &faster) const
+    {
+        ScoreRecord key;
+        key.id = maze.getId();
+        key.seconds = time;
+        faster = store.rank(Board::MAZE, key);
+        vector<ScoreRecord> best = store.leaderboard(Board::MAZE, key, 1);
+        return best.empty() ? time : best[0].seconds;
     }
 
     void showHighScores()
@@ -258,7 +286,8 @@ public:
             console.setColor(ConsoleColor::WHITE);
             cout << "=== " << difficultyNames[i] << " ===";
 
-            if (highScores[i].empty())
+            vector<ScoreRecord> highScores = store.leaderboard(Board::DIFFICULTY, difficultyKey(i), MAX_HIGH_SCORES);
+            if (highScores.empty())
             {
                 console.gotoXY(20, 8 + i * 7);
                 console.setColor(ConsoleColor::LIGHTGRAY);
@@ -266,12 +295,12 @@ public:
             }
             else
             {
-                for (size_t j = 0; j < highScores[i].size(); j++)
+                for (size_t j = 0; j < highScores.size(); j++)
                 {
                     console.gotoXY(20, 8 + j + i * 7);
                     console.setColor(j == 0 ? ConsoleColor::YELLOW : (j == 1 ? ConsoleColor::LIGHTCYAN : ConsoleColor::WHITE));
-                    cout << j + 1 << ". " << fixed << setprecision(2) << highScores[i][j].time
-                         << " seconds  (" << highScores[i][j].date << ")";
+                    cout << j + 1 << ". " << fixed << setprecision(2) << highScores[j].seconds
+                         << " seconds  (" << formatDate(highScores[j].timestamp) << ")";
                 }
             }
         }
@@ -289,469 +318,114 @@ public:
     }
 };
 
-class Maze
+class Game
 {
 private:
-    static const char WALL = '#';
-    static const char PATH = ' ';
-    static const char PLAYER = 'P';
-    static const char EXIT = 'E';
-    static const char VISITED = '*';
-    static const char SOLUTION = '+';
-    static const char TRAIL = '.';
-
-    int ROWS, COLS, WALL_DENSITY;
-    vector<vector<char>> maze;
-    vector<vector<bool>> playerTrail;
-    stack<pair<int, int>> playerPath;
-    pair<int, int> playerPos;
-    pair<int, int> exitPos;
-    bool showingSolution;
-    vector<pair<int, int>> solutionPath;
-    vector<pair<int, int>> fullSolutionPath;
-    high_resolution_clock::time_point startTime;
-    double elapsedSeconds;
-    int stepCount;
-
-    bool isValidMove(int x, int y)
-    {
-        return (x >= 0 && x < ROWS && y >= 0 && y < COLS &&
-                (maze[x][y] == PATH || maze[x][y] == EXIT || maze[x][y] == VISITED || maze[x][y] == SOLUTION));
-    }
-
-    void findSolutionPath()
-    {
-        solutionPath.clear();
-
-        queue<pair<int, int>> q;
-        vector<vector<bool>> visited(ROWS, vector<bool>(COLS, false));
-        vector<vector<pair<int, int>>> parent(ROWS, vector<pair<int, int>>(COLS, {-1, -1}));
-
-        q.push(playerPos);
-        visited[playerPos.first][playerPos.second] = true;
-
-        int dx[] = {-1, 1, 0, 0};
-        int dy[] = {0, 0, -1, 1};
-
-        bool found = false;
-
-        while (!q.empty() && !found)
-        {
-            auto [x, y] = q.front();
-            q.pop();
-
-            if (x == exitPos.first && y == exitPos.second)
-            {
-                found = true;
-                break;
-            }
-
-            for (int i = 0; i < 4; i++)
-            {
-                int nx = x + dx[i];
-                int ny = y + dy[i];
-                if (isValidMove(nx, ny) && !visited[nx][ny])
-                {
-                    visited[nx][ny] = true;
-                    parent[nx][ny] = {x, y};
-                    q.push({nx, ny});
-                }
-            }
-        }
-
-        if (found)
-        {
-            pair<int, int> current = exitPos;
-            while (current != playerPos && current != parent[current.first][current.second])
-            {
-                solutionPath.push_back(current);
-                current = parent[current.first][current.second];
-            }
-
-            if (current == playerPos)
-            {
-                solutionPath.push_back(current);
-            }
-
-            reverse(solutionPath.begin(), solutionPath.end());
-        }
-    }
-
-public:
-    Maze() : ROWS(0), COLS(0), WALL_DENSITY(0), showingSolution(false), elapsedSeconds(0.0) {}
+    Console console;
+    ScoreManager scoreManager;
+    Maze maze;
+    FrameBuffer frame;
+    Difficulty currentDifficulty;
+    bool showProfile;
+    ConsoleInput input;
+    InputRecorder recorder;
 
-    void init(Difficulty difficulty)
+    static string formatSeconds(double seconds, int precision)
     {
-        random_device rd;
-        mt19937 gen(rd());
-
-        switch (difficulty)
-        {
-        case Difficulty::EASY:
-            ROWS = 11;
-            COLS = 19;
-            WALL_DENSITY = 20;
-            break;
-        case Difficulty::MEDIUM:
-            ROWS = 15;
-            COLS = 27;
-            WALL_DENSITY = 30;
-            break;
-        case Difficulty::HARD:
-            ROWS = 21;
-            COLS = 39;
-            WALL_DENSITY = 40;
-            break;
-        }
-
-        maze.assign(ROWS, vector<char>(COLS, WALL));
-        playerTrail.assign(ROWS, vector<bool>(COLS, false));
-
-        while (!playerPath.empty())
-        {
-            playerPath.pop();
-        }
-
-        playerPos = {1, 1};
-        exitPos = {ROWS - 2, COLS - 2};
-        showingSolution = false;
-
-        stack<pair<int, int>> cells;
-        cells.push(playerPos);
-        maze[playerPos.first][playerPos.second] = PATH;
-
-        int dx[] = {-2, 2, 0, 0};
-        int dy[] = {0, 0, -2, 2};
-
-        while (!cells.empty())
-        {
-            auto [x, y] = cells.top();
-
-            vector<int> directions = {0, 1, 2, 3};
-            shuffle(directions.begin(), directions.end(), gen);
-
-            bool found = false;
-            for (int dir : directions)
-            {
-                int nx = x + dx[dir];
-                int ny = y + dy[dir];
-
-                if (nx > 0 && nx < ROWS - 1 && ny > 0 && ny < COLS - 1 && maze[nx][ny] == WALL)
-                {
-                    maze[nx][ny] = PATH;
-                    maze[x + dx[dir] / 2][y + dy[dir] / 2] = PATH;
-
-                    cells.push({nx, ny});
-                    found = true;
-                    break;
-                }
-            }
-
-            if (!found)
-                cells.pop();
-        }
-
-        maze[exitPos.first][exitPos.second] = EXIT;
-        maze[playerPos.first][playerPos.second] = PLAYER;
-
-        playerPath.push(playerPos);
-
-        findSolutionPath();
-        fullSolutionPath = solutionPath;
-
-        startTime = high_resolution_clock::now();
-        elapsedSeconds = 0.0;
-        stepCount = 0;
+        ostringstream out;
+        out << fixed << setprecision(precision) << seconds;
+        return out.str();
     }
 
-    void movePlayer(int dx, int dy)
+    void printStats(int startX, int startY)
     {
-        int newX = playerPos.first + dx;
-        int newY = playerPos.second + dy;
-
-        if (isValidMove(newX, newY))
-        {
-            bool backtracking = false;
-
-            if (playerPath.size() > 1)
-            {
-                auto prevPos = playerPath.top();
-                playerPath.pop();
-                auto prevPrevPos = playerPath.top();
-                playerPath.push(prevPos);
-
-                if (prevPrevPos.first == newX && prevPrevPos.second == newY)
-                {
-                    backtracking = true;
-                    playerPath.pop();
-                }
-            }
-
-            if (playerPos != exitPos)
-            {
-                maze[playerPos.first][playerPos.second] = PATH;
-            }
-            else
-            {
-                maze[playerPos.first][playerPos.second] = EXIT;
-            }
-
-            if (!backtracking)
-            {
-                playerTrail[playerPos.first][playerPos.second] = true;
-                playerPath.push({newX, newY});
-            }
-            else
-            {
-                playerTrail[playerPos.first][playerPos.second] = false;
-                playerTrail[newX][newY] = false;
-            }
-
-            playerPos = {newX, newY};
-            stepCount++;
-            findSolutionPath();
-
-            if (playerPos != exitPos)
-            {
-                maze[newX][newY] = PLAYER;
-            }
-        }
-    }
+        MAZE_PROFILE_SCOPE("printStats");
+        maze.updateTimer();
 
-    void clearVisited()
-    {
-        for (int i = 0; i < ROWS; i++)
-        {
-            for (int j = 0; j < COLS; j++)
-            {
-                if (maze[i][j] == VISITED || maze[i][j] == SOLUTION)
-                {
-                    maze[i][j] = PATH;
-                }
-            }
-        }
-        showingSolution = false;
+        frame.text(startX, startY, "Mode: " + scoreManager.getDifficultyName(currentDifficulty), ConsoleColor::WHITE);
+        frame.text(startX, startY + 1, "Time: " + formatSeconds(maze.getElapsedTime(), 1) + "s", ConsoleColor::WHITE);
+        frame.text(startX, startY + 2, "Path: " + to_string(maze.getPathLength()) + " steps", ConsoleColor::WHITE);
+        frame.text(startX, startY + 3, "Optimal: " + to_string(maze.getOptimalPathLength()) + " steps",
+                   ConsoleColor::WHITE);
+        frame.text(startX, startY + 4, "To exit: " + to_string(maze.getRemainingDistance()) + " steps",
+                   ConsoleColor::WHITE);
+        frame.text(startX, startY + 5, "ID: " + maze.getId().toString(), ConsoleColor::WHITE);
     }
 
-    void clearTrail()
+    void printLegend(int startX, int startY)
     {
-        for (auto &row : playerTrail)
-        {
-            fill(row.begin(), row.end(), false);
-        }
+        MAZE_PROFILE_SCOPE("printLegend");
+        frame.text(startX, startY, "P - Player", ConsoleColor::LIGHTGREEN);
+        frame.text(startX, startY + 1, "E - Exit", ConsoleColor::LIGHTMAGENTA);
+        frame.text(startX, startY + 2, ". - Trail", ConsoleColor::YELLOW);
 
-        pair<int, int> currentPos = playerPos;
-        while (!playerPath.empty())
+        if (maze.isShowingSolution())
         {
-            playerPath.pop();
+            frame.text(startX, startY + 3, "+ - Solution", ConsoleColor::LIGHTRED);
         }
-        playerPath.push(currentPos);
     }
 
-    void toggleSolution()
+    void printControls(int startX, int startY)
     {
-        showingSolution = !showingSolution;
-
-        if (!showingSolution)
+        MAZE_PROFILE_SCOPE("printControls");
+        const char *controls[] = {"WASD/Arrows - Move", "F - Show solution", "C - Clear trail", "R - Restart",
+                                  "H - High scores",
+                                  profiler::enabled() ? "P - Timings" : "P - Timings (disabled)", "Q - Quit"};
+        for (int i = 0; i < 7; i++)
         {
-            clearVisited();
+            frame.text(startX, startY + i, controls[i], ConsoleColor::LIGHTCYAN);
         }
     }
 
-    bool isCompleted() const
-    {
-        return playerPos == exitPos;
-    }
-
-    int getRows() const { return ROWS; }
-    int getCols() const { return COLS; }
-    const pair<int, int> &getPlayerPosition() const { return playerPos; }
-    const pair<int, int> &getExitPosition() const { return exitPos; }
-    bool isShowingSolution() const { return showingSolution; }
-    int getPathLength() const { return stepCount; }
-    int getOptimalPathLength() const { return fullSolutionPath.size(); }
-    void updateTimer()
-    {
-        auto currentTime = high_resolution_clock::now();
-        elapsedSeconds = duration_cast<milliseconds>(currentTime - startTime).count() / 1000.0;
-    }
-
-    double getElapsedTime() const
-    {
-        return elapsedSeconds;
-    }
-
-    void render(Console &console, int startX, int startY)
+    void renderMaze(int startX, int startY)
     {
-        for (int i = 0; i < ROWS; i++)
+        MAZE_PROFILE_SCOPE("render");
+        for (int i = 0; i < maze.getRows(); i++)
         {
-            console.gotoXY(startX, startY + i);
-
-            for (int j = 0; j < COLS; j++)
+            for (int j = 0; j < maze.getCols(); j++)
             {
-                if (i == playerPos.first && j == playerPos.second)
-                {
-                    console.setColor(ConsoleColor::LIGHTGREEN);
-                    cout << PLAYER;
-                    console.resetColor();
-                }
-                else if (i == exitPos.first && j == exitPos.second)
-                {
-                    console.setColor(ConsoleColor::LIGHTMAGENTA);
-                    cout << EXIT;
-                    console.resetColor();
-                }
-                else if (showingSolution)
-                {
-                    bool isSolution = false;
-                    for (const auto &cell : solutionPath)
-                    {
-                        if (cell.first == i && cell.second == j)
-                        {
-                            isSolution = true;
-                            break;
-                        }
-                    }
-
-                    if (isSolution)
-                    {
-                        console.setColor(ConsoleColor::LIGHTRED);
-                        cout << SOLUTION;
-                        console.resetColor();
-                    }
-                    else if (playerTrail[i][j] && maze[i][j] == PATH)
-                    {
-                        console.setColor(ConsoleColor::YELLOW);
-                        cout << TRAIL;
-                        console.resetColor();
-                    }
-                    else if (maze[i][j] == WALL)
-                    {
-                        console.setColor(ConsoleColor::BLUE);
-                        cout << WALL;
-                        console.resetColor();
-                    }
-                    else
-                    {
-                        cout << maze[i][j];
-                    }
-                }
-                else if (playerTrail[i][j] && maze[i][j] == PATH)
-                {
-                    console.setColor(ConsoleColor::YELLOW);
-                    cout << TRAIL;
-                    console.resetColor();
-                }
-                else if (maze[i][j] == WALL)
-                {
-                    console.setColor(ConsoleColor::BLUE);
-                    cout << WALL;
-                    console.resetColor();
-                }
-                else
-                {
-                    cout << maze[i][j];
-                }
+                CellView view = maze.cellView(i, j);
+                frame.put(startX + j, startY + i, Maze::glyph(view), Maze::color(view));
             }
         }
     }
-};
-
-const char Maze::WALL;
-
-class Game
-{
-private:
-    Console console;
-    ScoreManager scoreManager;
-    Maze maze;
-    Difficulty currentDifficulty;
-
-    void printStats(int startX, int startY)
-    {
-        maze.updateTimer();
-
-        console.gotoXY(startX, startY);
-        console.setColor(ConsoleColor::WHITE);
-        cout << "Mode: " << scoreManager.getDifficultyName(currentDifficulty);
-
-        console.gotoXY(startX, startY + 1);
-        cout << "Time: " << fixed << setprecision(1) << maze.getElapsedTime() << "s";
-
-        console.gotoXY(startX, startY + 2);
-        cout << "Path: " << maze.getPathLength() << " steps";
-
-        console.gotoXY(startX, startY + 3);
-        cout << "Optimal: " << maze.getOptimalPathLength() << " steps";
-
-        console.resetColor();
-    }
-
-    void printLegend(int startX, int startY)
-    {
-        console.gotoXY(startX, startY);
-        console.setColor(ConsoleColor::LIGHTGREEN);
-        cout << 'P' << " - Player";
-
-        console.gotoXY(startX, startY + 1);
-        console.setColor(ConsoleColor::LIGHTMAGENTA);
-        cout << 'E' << " - Exit";
-
-        console.gotoXY(startX, startY + 2);
-        console.setColor(ConsoleColor::YELLOW);
-        cout << '.' << " - Trail";
-
-        if (maze.isShowingSolution())
-        {
-            console.gotoXY(startX, startY + 3);
-            console.setColor(ConsoleColor::LIGHTRED);
-            cout << '+' << " - Solution";
-        }
-
-        console.resetColor();
-    }
-
-    void printControls(int startX, int startY)
-    {
-        console.gotoXY(startX, startY);
-        console.setColor(ConsoleColor::LIGHTCYAN);
-        cout << "WASD/Arrows - Move";
-
-        console.gotoXY(startX, startY + 1);
-        cout << "F - Show solution";
-
-        console.gotoXY(startX, startY + 2);
-        cout << "C - Clear trail";
-
-        console.gotoXY(startX, startY + 3);
-        cout << "R - Restart";
-
-        console.gotoXY(startX, startY + 4);
-        cout << "H - High scores";
-
-        console.gotoXY(startX, startY + 5);
-        cout << "Q - Quit";
-
-        console.resetColor();
-    }
 
+    // Builds the whole game screen in the frame buffer, then writes out only
+    // the cells that differ from what is already on the console.
     void printMaze()
     {
+        MAZE_PROFILE_SCOPE("frame");
+        const char BORDER = (char)219;
         int startX = 2;
         int startY = 2;
         int panelX = startX + maze.getCols() + 4;
+        int panelHeight = max(maze.getRows() + 2, 22);
 
-        console.drawBox(startX - 1, startY - 1, maze.getCols() + 2, maze.getRows() + 2);
-
-        maze.render(console, startX, startY);
-
-        int panelHeight = max(maze.getRows() + 2, 20);
+        vector<string> overlay;
+        if (showProfile)
+        {
+            overlay = profiler::overlayLines();
+        }
+        frame.resize(panelX + 32, startY - 1 + panelHeight + (overlay.empty() ? 0 : overlay.size() + 1));
+        frame.clear();
+        for (size_t i = 0; i < overlay.size(); i++)
+        {
+            frame.text(startX - 1, startY + panelHeight + static_cast<int>(i), overlay[i], ConsoleColor::DARKGRAY);
+        }
 
-        console.drawBox(panelX, startY - 1, 30, panelHeight);
+        frame.box(startX - 1, startY - 1, maze.getCols() + 2, maze.getRows() + 2, BORDER, ConsoleColor::WHITE);
+        renderMaze(startX, startY);
 
+        frame.box(panelX, startY - 1, 32, panelHeight, BORDER, ConsoleColor::WHITE);
         printLegend(panelX + 4, startY + 1);
         printStats(panelX + 4, startY + 7);
-        printControls(panelX + 4, startY + 12);
+        printControls(panelX + 4, startY + 13);
+
+        MAZE_PROFILE_SCOPE("present");
+        frame.present([this](int x, int y, const char *text, int length, ConsoleColor color) {
+            console.write(x, y, text, length, color);
+        });
+        console.resetColor();
     }
 
     bool playAgainPrompt()
@@ -759,7 +433,10 @@ private:
         console.clearScreen();
         double completionTime = maze.getElapsedTime();
 
-        bool isHighScore = scoreManager.addHighScore(currentDifficulty, completionTime);
+        bool isHighScore = false;
+        bool saved = scoreManager.addHighScore(currentDifficulty, maze, completionTime, isHighScore);
+        size_t fasterOnMaze = 0;
+        double bestOnMaze = scoreManager.bestOnMaze(maze, completionTime, fasterOnMaze);
 
         console.drawBox(20, 8, 40, 14);
 
@@ -777,6 +454,9 @@ private:
         console.gotoXY(25, 14);
         cout << "Optimal path: " << maze.getOptimalPathLength() << " steps";
 
+        console.gotoXY(25, 15);
+        cout << "ID: " << maze.getId().toString();
+
         if (isHighScore)
         {
             console.gotoXY(25, 16);
@@ -784,6 +464,18 @@ private:
             cout << "NEW HIGH SCORE!";
         }
 
+        console.gotoXY(25, 17);
+        if (saved)
+        {
+            console.setColor(ConsoleColor::WHITE);
+            cout << "Best on this maze: " << fixed << setprecision(2) << bestOnMaze << "s (#" << fasterOnMaze + 1 << ")";
+        }
+        else
+        {
+            console.setColor(ConsoleColor::LIGHTRED);
+            cout << "Score could not be saved!";
+        }
+
         console.gotoXY(25, 18);
         console.setColor(ConsoleColor::LIGHTCYAN);
         cout << "Play again?";
@@ -918,6 +610,9 @@ private:
         console.gotoXY(10, startY++);
         cout << "- H: View high scores";
 
+        console.gotoXY(10, startY++);
+        cout << "- P: Show frame timings";
+
         console.gotoXY(10, startY++);
         cout << "- Q: Quit to menu";
 
@@ -997,70 +692,44 @@ private:
     {
         bool playing = true;
         bool completed = false;
-        char input;
         console.clearScreen();
+        frame.invalidate();
         while (playing)
         {
             maze.init(currentDifficulty);
+            recorder.beginSession(maze.getId(), input.elapsedMs());
             completed = false;
 
             while (!completed && playing)
             {
                 printMaze();
 
-                input = _getch();
+                InputEvent event;
+                input.next(event);
 
-                switch (tolower(input))
+                // Handling the key, not waiting for it.
                 {
-                case 'w':
-                    maze.movePlayer(-1, 0);
-                    break;
-                case 'a':
-                    maze.movePlayer(0, -1);
-                    break;
-                case 's':
-                    maze.movePlayer(1, 0);
-                    break;
-                case 'd':
-                    maze.movePlayer(0, 1);
-                    break;
-                case 'f':
-                    maze.toggleSolution();
-                    break;
-                case 'c':
-                    maze.clearTrail();
-                    break;
-                case 'r':
-                    maze.init(currentDifficulty);
-                    break;
-                case 'h':
-                    scoreManager.showHighScores();
-                    console.clearScreen();
-                    break;
-                case 'q':
-                    playing = false;
-                    break;
-                case -32:
-                case 224:
-                    input = _getch();
-                    switch (input)
+                    MAZE_PROFILE_SCOPE("input");
+                    recorder.record(event);
+                    applyCommand(maze, event.command);
+                    switch (event.command)
                     {
-                    case 72:
-                        maze.movePlayer(-1, 0);
+                    case Command::HIGH_SCORES:
+                        scoreManager.showHighScores();
+                        console.clearScreen();
+                        frame.invalidate();
                         break;
-                    case 75:
-                        maze.movePlayer(0, -1);
+                    case Command::PROFILE:
+                        showProfile = !showProfile;
+                        console.clearScreen();
+                        frame.invalidate();
                         break;
-                    case 80:
-                        maze.movePlayer(1, 0);
+                    case Command::QUIT:
+                        playing = false;
                         break;
-                    case 77:
-                        maze.movePlayer(0, 1);
+                    default:
                         break;
                     }
-                    break;
-                default:
-                    break;
                 }
 
                 if (maze.isCompleted())
@@ -1068,15 +737,22 @@ private:
                     completed = true;
                     playing = playAgainPrompt();
                     console.clearScreen();
+                    frame.invalidate();
                 }
             }
         }
     }
 
 public:
-    Game() : scoreManager(console), currentDifficulty(Difficulty::EASY)
+    Game() : scoreManager(console), currentDifficulty(Difficulty::EASY), showProfile(false)
     {
-        srand(static_cast<unsigned int>(time(nullptr)));
+        maze.setNextHopTable(true);
+    }
+
+    // Appends every maze played and the moves made on it to path.
+    bool recordTo(const string &path)
+    {
+        return recorder.open(path);
     }
 
     void run()
@@ -1117,9 +793,20 @@ public:
     }
 };
 
-int main()
+int main(int argc, char **argv)
 {
     Game mazeGame;
+    if (argc == 3 && string(argv[1]) == "--record" && !mazeGame.recordTo(argv[2]))
+    {
+        cerr << "cannot open " << argv[2] << endl;
+        return 1;
+    }
     mazeGame.run();
+
+    if (profiler::enabled())
+    {
+        ofstream profile("maze_profile.json");
+        profiler::writeJson(profile);
+    }
     return 0;
 }
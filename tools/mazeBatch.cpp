@@ -0,0 +1,261 @@
+// Batch generator for puzzle packs: builds N mazes on a work-stealing thread
+// pool and writes them to one packed file (see core/MazePack.h).
+//
+// Maze i gets seed S + i and size i of the --size list (cycled), so a pack is
+// fully determined by its command line, whatever the thread count. Each worker
+// keeps its own Maze (and with it the grid buffer and the generator state), its
+// own packing buffer and its own file handle; the offsets are laid out before
+// any maze is generated, so workers never coordinate on output.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/Maze.h"
+#include "core/MazePack.h"
+#include "core/WorkStealingPool.h"
+
+using namespace std;
+using namespace chrono;
+
+struct Options
+{
+    long long count = 0;
+    vector<pair<int, int>> sizes;
+    Generator generator = Generator::DFS;
+    int braid = 0;
+    uint64_t seed = 1;
+    unsigned threads = 0;
+    string outPath;
+    bool verify = false;
+};
+
+struct Worker
+{
+    Maze maze;
+    vector<uint64_t> words;
+    vector<uint64_t> expected;
+    fstream file;
+    long long mazes = 0;
+    long long failures = 0;
+};
+
+static void printUsage(const char *argv0)
+{
+    cout << "Usage: " << argv0 << " --count N --out FILE [options]\n"
+         << "  --size RxC                     maze size, repeat for a mix (default 21x39)\n"
+         << "  --generator NAME               carving algorithm: dfs (default),\n"
+         << "                                 backtrack, eller, kruskal, wilson, binarytree,\n"
+         << "                                 sidewinder or growingtree\n"
+         << "  --braid PERCENT                open this share of dead ends into loops (default 0)\n"
+         << "  --seed S                       maze i uses seed S + i (default 1)\n"
+         << "  --threads T                    worker threads (default: all cores)\n"
+         << "  --verify                       read the pack back and compare every maze\n";
+}
+
+static bool parseSize(const string &text, pair<int, int> &size)
+{
+    int rows = 0, cols = 0;
+    char cross = 0;
+    if (sscanf(text.c_str(), "%d%c%d", &rows, &cross, &cols) != 3 || cross != 'x' || rows <= 0 || cols <= 0)
+    {
+        return false;
+    }
+    size = {rows, cols};
+    return true;
+}
+
+static bool parseOptions(int argc, char **argv, Options &opts)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--count" && hasValue)
+        {
+            opts.count = atoll(argv[++i]);
+        }
+        else if (arg == "--size" && hasValue)
+        {
+            pair<int, int> size;
+            if (!parseSize(argv[++i], size))
+                return false;
+            opts.sizes.push_back(size);
+        }
+        else if (arg == "--generator" && hasValue)
+        {
+            if (!parseGenerator(argv[++i], opts.generator))
+                return false;
+        }
+        else if (arg == "--braid" && hasValue)
+        {
+            opts.braid = atoi(argv[++i]);
+        }
+        else if (arg == "--seed" && hasValue)
+        {
+            opts.seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--threads" && hasValue)
+        {
+            opts.threads = static_cast<unsigned>(atoi(argv[++i]));
+        }
+        else if (arg == "--out" && hasValue)
+        {
+            opts.outPath = argv[++i];
+        }
+        else if (arg == "--verify")
+        {
+            opts.verify = true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    if (opts.sizes.empty())
+    {
+        opts.sizes.push_back({21, 39});
+    }
+    return opts.count > 0 && opts.count <= UINT32_MAX && !opts.outPath.empty() && opts.braid >= 0 &&
+           opts.braid <= MAX_BRAID;
+}
+
+int main(int argc, char **argv)
+{
+    Options opts;
+    if (!parseOptions(argc, argv, opts))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    vector<MazeId> ids(opts.count);
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        const pair<int, int> &size = opts.sizes[i % opts.sizes.size()];
+        ids[i].generator = opts.generator;
+        ids[i].rows = size.first;
+        ids[i].cols = size.second;
+        ids[i].seed = opts.seed + i;
+        ids[i].braid = static_cast<uint8_t>(opts.braid);
+    }
+
+    vector<MazePackEntry> entries;
+    uint64_t fileBytes = layoutMazePack(ids, entries);
+
+    // Create the file at its final size; workers then fill in their mazes.
+    {
+        ofstream out(opts.outPath, ios::binary | ios::trunc);
+        if (!writeMazePackIndex(out, entries))
+        {
+            cerr << "cannot write " << opts.outPath << "\n";
+            return 1;
+        }
+        out.seekp(static_cast<streamoff>(fileBytes - 1));
+        out.put('\0');
+        if (!out.good())
+        {
+            cerr << "cannot write " << opts.outPath << "\n";
+            return 1;
+        }
+    }
+
+    WorkStealingPool pool(opts.threads);
+    vector<Worker> workers(pool.size());
+    for (Worker &worker : workers)
+    {
+        // The pool already keeps every core busy with whole mazes; a distance
+        // field pool per worker on top of it would run threads squared.
+        if (pool.size() > 1)
+        {
+            worker.maze.setDistanceThreads(1);
+        }
+        worker.file.open(opts.outPath, ios::binary | ios::in | ios::out);
+        if (!worker.file.good())
+        {
+            cerr << "cannot open " << opts.outPath << "\n";
+            return 1;
+        }
+    }
+
+    auto t0 = high_resolution_clock::now();
+    pool.run(ids.size(), [&](unsigned w, size_t i) {
+        Worker &worker = workers[w];
+        MazePackEntry &entry = entries[i];
+
+        worker.maze.init(ids[i]);
+        entry.optimalPathLength = static_cast<uint32_t>(worker.maze.getOptimalPathLength());
+
+        worker.words.resize(packedMazeWords(entry.rows, entry.cols));
+        packGrid(worker.maze.getGrid(), worker.words.data());
+        worker.file.seekp(static_cast<streamoff>(entry.offset));
+        worker.file.write(reinterpret_cast<const char *>(worker.words.data()), worker.words.size() * sizeof(uint64_t));
+        worker.mazes++;
+    });
+
+    bool ok = true;
+    for (Worker &worker : workers)
+    {
+        worker.file.flush();
+        ok = ok && worker.file.good();
+    }
+    {
+        fstream out(opts.outPath, ios::binary | ios::in | ios::out);
+        ok = ok && writeMazePackIndex(out, entries);
+    }
+    double seconds = duration<double>(high_resolution_clock::now() - t0).count();
+    if (!ok)
+    {
+        cerr << "failed to write " << opts.outPath << "\n";
+        return 1;
+    }
+
+    cout << fixed << setprecision(3)
+         << "mazes:   " << ids.size() << " -> " << opts.outPath << " (" << fileBytes / (1024.0 * 1024.0) << " MiB)\n"
+         << "threads: " << pool.size() << "\n"
+         << "time:    " << seconds * 1000.0 << " ms (" << setprecision(1) << ids.size() / seconds << " mazes/s)\n"
+         << "per worker:";
+    for (const Worker &worker : workers)
+    {
+        cout << " " << worker.mazes;
+    }
+    cout << "\n";
+
+    if (opts.verify)
+    {
+        vector<MazePackEntry> stored;
+        if (!readMazePackIndex(workers[0].file, stored) || stored.size() != entries.size())
+        {
+            cerr << "verify: bad index\n";
+            return 1;
+        }
+        pool.run(stored.size(), [&](unsigned w, size_t i) {
+            Worker &worker = workers[w];
+            const MazePackEntry &entry = stored[i];
+
+            worker.maze.init(packEntryId(entry));
+            worker.expected.resize(packedMazeWords(entry.rows, entry.cols));
+            packGrid(worker.maze.getGrid(), worker.expected.data());
+            if (!readPackedMaze(worker.file, entry, worker.words) || worker.words != worker.expected ||
+                entry.optimalPathLength != static_cast<uint32_t>(worker.maze.getOptimalPathLength()))
+            {
+                worker.failures++;
+            }
+        });
+
+        long long failures = 0;
+        for (const Worker &worker : workers)
+        {
+            failures += worker.failures;
+        }
+        cout << "verify:  " << (failures == 0 ? "ok" : to_string(failures) + " mazes differ") << "\n";
+        return failures == 0 ? 0 : 1;
+    }
+    return 0;
+}
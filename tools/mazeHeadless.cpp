@@ -0,0 +1,751 @@
+// Headless driver for the maze core: generates, plays and solves mazes without
+// a console so the core can be run under perf, valgrind and friends on Linux.
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <new>
+#include <random>
+#include <string>
+
+#include "core/InputLog.h"
+#include "core/LayeredMaze.h"
+#include "core/Maze.h"
+#include "core/MazeFile.h"
+#include "core/Profiler.h"
+#include "core/MazeStream.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+using namespace std;
+using namespace chrono;
+
+// Every heap allocation in the process goes through these, so the run can
+// report how many happened while generating mazes and while moving.
+static atomic<long long> allocationCount{0};
+
+static void *countedAlloc(size_t size)
+{
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+static void *countedAlignedAlloc(size_t size, align_val_t align)
+{
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    size_t alignment = max(static_cast<size_t>(align), sizeof(void *));
+    void *p = nullptr;
+#if defined(_WIN32)
+    p = _aligned_malloc(size ? size : 1, alignment);
+#else
+    if (posix_memalign(&p, alignment, size ? size : 1) != 0)
+    {
+        p = nullptr;
+    }
+#endif
+    if (!p)
+    {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+static void countedAlignedFree(void *p)
+{
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+void *operator new(size_t size) { return countedAlloc(size); }
+void *operator new[](size_t size) { return countedAlloc(size); }
+void *operator new(size_t size, align_val_t align) { return countedAlignedAlloc(size, align); }
+void *operator new[](size_t size, align_val_t align) { return countedAlignedAlloc(size, align); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+void operator delete(void *p, align_val_t) noexcept { countedAlignedFree(p); }
+void operator delete[](void *p, align_val_t) noexcept { countedAlignedFree(p); }
+void operator delete(void *p, size_t, align_val_t) noexcept { countedAlignedFree(p); }
+void operator delete[](void *p, size_t, align_val_t) noexcept { countedAlignedFree(p); }
+
+struct Options
+{
+    Difficulty difficulty = Difficulty::HARD;
+    int rows = 0;
+    int cols = 0;
+    Generator generator = Generator::DFS;
+    int braid = 0;
+    int levels = 0;
+    int stairs = LayeredMaze::DEFAULT_STAIRS_PERCENT;
+    string streamPath;
+    string savePath;
+    bool saveDistances = false;
+    string loadPath;
+    uint64_t seed = 1;
+    bool hasSeed = false;
+    MazeId id;
+    bool hasId = false;
+    vector<SolverKind> solvers;
+    int repeat = 1;
+    int randomMoves = 0;
+    bool solve = false;
+    bool nextHops = false;
+    unsigned distanceThreads = 0;
+    bool print = false;
+    string profileJson;
+    string recordPath;
+    vector<string> replayPaths;
+};
+
+static void printUsage(const char *argv0)
+{
+    cout << "Usage: " << argv0 << " [options]\n"
+         << "  --difficulty easy|medium|hard  maze size (default hard)\n"
+         << "  --rows R --cols C              custom maze size instead of a difficulty\n"
+         << "  --generator NAME               carving algorithm for custom sizes: dfs (default),\n"
+         << "                                 backtrack, eller, kruskal, wilson, binarytree,\n"
+         << "                                 sidewinder or growingtree\n"
+         << "  --braid PERCENT                open this share of dead ends into loops (default 0)\n"
+         << "  --levels N                     build layered mazes of N levels joined by stairs\n"
+         << "                                 (--rows x --cols per level, default 21x39)\n"
+         << "  --stairs PERCENT               how often the layered carver takes a stair when it\n"
+         << "                                 could stay on the level (default 10)\n"
+         << "  --stream FILE                  stream an Eller maze of --rows x --cols to FILE\n"
+         << "  --save FILE                    save the last maze as a maze file\n"
+         << "  --distances                    include the distance field when saving\n"
+         << "  --load FILE                    map a maze file and solve it in place\n"
+         << "  --seed S                       fixed seed; with --repeat, maze r uses S + r\n"
+         << "                                 (default: random, 1 for --stream)\n"
+         << "  --id ID                        regenerate the maze with this ID, e.g. dfs-21x39-2s\n"
+         << "  --solver NAME|all              run a solver on each new maze and report its stats\n"
+         << "                                 (bfs, astar, bidirectional, deadend, wallfollower,\n"
+         << "                                 parallelbfs, bitbfs); fails on a wrong path\n"
+         << "  --repeat N                     generate N mazes (default 1)\n"
+         << "  --random-moves N               make N random moves per maze\n"
+         << "  --solve                        walk the solution path to the exit\n"
+         << "  --next-hops                    build the 2-bit next-hop table with each maze\n"
+         << "  --distance-threads N           threads for the distance field of mazes of about\n"
+         << "                                 2000x2000 and up (default: all, 1: no pool)\n"
+         << "  --print                        print the final maze\n"
+         << "  --profile-json FILE            write hot-path timings (profiling builds)\n"
+         << "  --record FILE                  append each maze and the moves made on it to FILE\n"
+         << "  --replay FILE                  replay every session recorded in FILE at full\n"
+         << "                                 speed without rendering (repeatable)\n";
+}
+
+static bool parseOptions(int argc, char **argv, Options &opts)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--difficulty" && hasValue)
+        {
+            string value = argv[++i];
+            if (value == "easy")
+                opts.difficulty = Difficulty::EASY;
+            else if (value == "medium")
+                opts.difficulty = Difficulty::MEDIUM;
+            else if (value == "hard")
+                opts.difficulty = Difficulty::HARD;
+            else
+                return false;
+        }
+        else if (arg == "--rows" && hasValue)
+        {
+            opts.rows = atoi(argv[++i]);
+        }
+        else if (arg == "--cols" && hasValue)
+        {
+            opts.cols = atoi(argv[++i]);
+        }
+        else if (arg == "--generator" && hasValue)
+        {
+            if (!parseGenerator(argv[++i], opts.generator))
+                return false;
+        }
+        else if (arg == "--braid" && hasValue)
+        {
+            opts.braid = atoi(argv[++i]);
+        }
+        else if (arg == "--levels" && hasValue)
+        {
+            opts.levels = atoi(argv[++i]);
+        }
+        else if (arg == "--stairs" && hasValue)
+        {
+            opts.stairs = atoi(argv[++i]);
+        }
+        else if (arg == "--stream" && hasValue)
+        {
+            opts.streamPath = argv[++i];
+        }
+        else if (arg == "--save" && hasValue)
+        {
+            opts.savePath = argv[++i];
+        }
+        else if (arg == "--distances")
+        {
+            opts.saveDistances = true;
+        }
+        else if (arg == "--load" && hasValue)
+        {
+            opts.loadPath = argv[++i];
+        }
+        else if (arg == "--seed" && hasValue)
+        {
+            opts.seed = strtoull(argv[++i], nullptr, 10);
+            opts.hasSeed = true;
+        }
+        else if (arg == "--id" && hasValue)
+        {
+            if (!MazeId::parse(argv[++i], opts.id))
+                return false;
+            opts.hasId = true;
+        }
+        else if (arg == "--solver" && hasValue)
+        {
+            string value = argv[++i];
+            SolverKind kind;
+            if (value == "all")
+                opts.solvers = allSolverKinds();
+            else if (parseSolverKind(value, kind))
+                opts.solvers.push_back(kind);
+            else
+                return false;
+        }
+        else if (arg == "--repeat" && hasValue)
+        {
+            opts.repeat = atoi(argv[++i]);
+        }
+        else if (arg == "--random-moves" && hasValue)
+        {
+            opts.randomMoves = atoi(argv[++i]);
+        }
+        else if (arg == "--solve")
+        {
+            opts.solve = true;
+        }
+        else if (arg == "--next-hops")
+        {
+            opts.nextHops = true;
+        }
+        else if (arg == "--distance-threads" && hasValue)
+        {
+            opts.distanceThreads = static_cast<unsigned>(atoi(argv[++i]));
+        }
+        else if (arg == "--print")
+        {
+            opts.print = true;
+        }
+        else if (arg == "--profile-json" && hasValue)
+        {
+            opts.profileJson = argv[++i];
+        }
+        else if (arg == "--record" && hasValue)
+        {
+            opts.recordPath = argv[++i];
+        }
+        else if (arg == "--replay" && hasValue)
+        {
+            opts.replayPaths.push_back(argv[++i]);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    if ((opts.rows > 0) != (opts.cols > 0) || (!opts.streamPath.empty() && opts.rows <= 0))
+    {
+        return false;
+    }
+    if (opts.levels < 0 || opts.levels > LayeredMaze::MAX_LEVELS || opts.stairs < 0 || opts.stairs > 100)
+    {
+        return false;
+    }
+    return opts.repeat > 0 && opts.randomMoves >= 0 && opts.braid >= 0 && opts.braid <= MAX_BRAID;
+}
+
+// Peak resident set size in MiB, or a negative value where unsupported.
+static double peakRssMiB()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+    return usage.ru_maxrss / 1024.0;
+#endif
+#else
+    return -1.0;
+#endif
+}
+
+// Maps a maze file and solves it without copying the grid.
+static int loadMaze(const string &file)
+{
+    auto t0 = high_resolution_clock::now();
+    MappedMaze mapped;
+    if (!mapped.open(file))
+    {
+        cerr << "cannot load " << file << "\n";
+        return 1;
+    }
+    auto t1 = high_resolution_clock::now();
+
+    BitBfs bfs;
+    vector<pair<int, int>> path;
+    long long visited = 0;
+    bool found = mapped.solve(bfs, path, visited);
+    auto t2 = high_resolution_clock::now();
+
+    const MazeFileHeader &header = mapped.header();
+    cout << fixed << setprecision(3)
+         << "loaded: " << file << " (" << header.rows << "x" << header.cols
+         << (mapped.distances() ? ", with distances" : "") << ")\n"
+         << "id:     " << mapped.id().toString() << "\n"
+         << "open:   " << duration<double, milli>(t1 - t0).count() << " ms\n"
+         << "solve:  " << duration<double, milli>(t2 - t1).count() << " ms, " << visited << " cells visited\n"
+         << "optimal path: ";
+    if (found)
+    {
+        cout << path.size() << " steps\n";
+    }
+    else
+    {
+        cout << "none\n";
+    }
+    cout << "peak rss: " << peakRssMiB() << " MiB\n";
+    return found ? 0 : 1;
+}
+
+// Replays recorded sessions through applyCommand as fast as possible. The
+// digest covers the final state of every session, so two builds that replay
+// the same logs must print the same one.
+static int replaySessions(const vector<string> &files)
+{
+    vector<RecordedSession> sessions;
+    for (const string &file : files)
+    {
+        if (!readInputLog(file, sessions))
+        {
+            cerr << "cannot read input log " << file << "\n";
+            return 1;
+        }
+    }
+
+    const char *names[] = {"up", "down", "left", "right", "solution", "clear", "restart"};
+    long long counts[7] = {};
+    long long events = 0;
+    long long completed = 0;
+    uint64_t digest = 14695981039346656037ull;
+    double initMs = 0.0;
+    double commandMs = 0.0;
+
+    Maze maze;
+    for (const RecordedSession &session : sessions)
+    {
+        auto t0 = high_resolution_clock::now();
+        maze.init(session.id);
+        auto t1 = high_resolution_clock::now();
+
+        ReplayInput input(session);
+        InputEvent event;
+        while (input.next(event))
+        {
+            applyCommand(maze, event.command);
+            counts[static_cast<int>(event.command)]++;
+        }
+        auto t2 = high_resolution_clock::now();
+        initMs += duration<double, milli>(t1 - t0).count();
+        commandMs += duration<double, milli>(t2 - t1).count();
+        events += static_cast<long long>(session.events.size());
+        completed += maze.isCompleted();
+
+        uint64_t state[] = {static_cast<uint64_t>(maze.getPlayerPosition().first),
+                            static_cast<uint64_t>(maze.getPlayerPosition().second),
+                            static_cast<uint64_t>(maze.getPathLength()), maze.isShowingSolution() ? 1u : 0u};
+        for (uint64_t value : state)
+        {
+            digest = (digest ^ value) * 1099511628211ull;
+        }
+    }
+
+    cout << fixed << setprecision(3) << "sessions: " << sessions.size() << " (" << completed << " completed)\n"
+         << "init:     " << initMs << " ms\n"
+         << "commands: " << events << " in " << commandMs << " ms";
+    if (events > 0)
+    {
+        cout << " (" << commandMs * 1e6 / events << " ns/command, " << events / commandMs / 1000.0
+             << " M commands/s)";
+    }
+    cout << "\n";
+    for (int c = 0; c < 7; c++)
+    {
+        if (counts[c] > 0)
+        {
+            cout << "  " << left << setw(9) << names[c] << right << counts[c] << "\n";
+        }
+    }
+    cout << "digest:   " << hex << digest << dec << "\n";
+    return 0;
+}
+
+static void printMaze(const Maze &maze)
+{
+    for (int i = 0; i < maze.getRows(); i++)
+    {
+        string line;
+        for (int j = 0; j < maze.getCols(); j++)
+        {
+            line += Maze::glyph(maze.cellView(i, j));
+        }
+        cout << line << '\n';
+    }
+}
+
+// Layered mazes: generation, an optional six-way BFS checked against the
+// carved solution, random moves and a walk to the exit.
+static int runLayered(const Options &opts)
+{
+    LayeredMaze maze;
+    mt19937 moveGen(12345);
+    double initMs = 0.0;
+    double solveMs = 0.0;
+    double moveMs = 0.0;
+    long long nodes = 0;
+    long long mismatches = 0;
+    long long moves = 0;
+    long long stairs = 0;
+
+    for (int r = 0; r < opts.repeat; r++)
+    {
+        uint64_t seed = opts.hasSeed ? opts.seed + r : Maze::randomSeed();
+        auto t0 = high_resolution_clock::now();
+        maze.init(opts.rows > 0 ? opts.rows : 21, opts.cols > 0 ? opts.cols : 39, opts.levels, seed, opts.stairs);
+        auto t1 = high_resolution_clock::now();
+        initMs += duration<double, milli>(t1 - t0).count();
+        stairs += maze.getStairCount();
+
+        if (!opts.solvers.empty())
+        {
+            long long expanded = 0;
+            int length = maze.solve(expanded);
+            solveMs += duration<double, milli>(high_resolution_clock::now() - t1).count();
+            nodes += expanded;
+            if (length != maze.getOptimalPathLength())
+            {
+                mismatches++;
+            }
+        }
+
+        auto m0 = high_resolution_clock::now();
+        for (int m = 0; m < opts.randomMoves && !maze.isCompleted(); m++)
+        {
+            maze.move(static_cast<int>(moveGen() % 6));
+            moves++;
+        }
+        if (opts.solve)
+        {
+            while (!maze.isCompleted())
+            {
+                LevelPos pos = maze.getPlayerPosition();
+                LevelPos next = maze.getNextStep();
+                int dir = next.level != pos.level ? (next.level < pos.level ? LevelGrid::ASCEND : LevelGrid::DESCEND)
+                          : next.row != pos.row   ? (next.row < pos.row ? LevelGrid::UP : LevelGrid::DOWN)
+                                                  : (next.col < pos.col ? LevelGrid::LEFT : LevelGrid::RIGHT);
+                if (!maze.move(dir))
+                {
+                    break;
+                }
+                moves++;
+            }
+        }
+        moveMs += duration<double, milli>(high_resolution_clock::now() - m0).count();
+    }
+
+    if (opts.print)
+    {
+        for (int level = 0; level < maze.getLevels(); level++)
+        {
+            cout << "level " << level + 1 << "\n";
+            for (int i = 0; i < maze.getRows(); i++)
+            {
+                string line;
+                for (int j = 0; j < maze.getCols(); j++)
+                {
+                    line += Maze::glyph(maze.cellView(level, i, j));
+                }
+                cout << line << '\n';
+            }
+        }
+    }
+
+    cout << fixed << setprecision(3) << "mazes: " << opts.repeat << " of " << maze.getRows() << "x"
+         << maze.getCols() << "x" << maze.getLevels() << " (seed " << maze.getSeed() << ")\n"
+         << "init:  " << initMs / opts.repeat << " ms/maze, " << stairs / opts.repeat << " stairs/maze\n";
+    if (!opts.solvers.empty())
+    {
+        cout << "solver bfs (6-way) " << solveMs / opts.repeat << " ms/solve, " << nodes / opts.repeat
+             << " nodes/solve";
+        if (mismatches > 0)
+        {
+            cout << ", " << mismatches << " wrong";
+        }
+        cout << "\n";
+    }
+    if (moves > 0)
+    {
+        cout << "moves: " << moves << " in " << moveMs << " ms\n";
+    }
+    cout << "optimal path: " << maze.getOptimalPathLength() << " steps\n"
+         << "completed: " << (maze.isCompleted() ? "yes" : "no") << "\n"
+         << "maze memory: " << maze.getBytes() / (1024.0 * 1024.0) << " MiB\n"
+         << "peak rss: " << peakRssMiB() << " MiB\n";
+    return mismatches == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    Options opts;
+    if (!parseOptions(argc, argv, opts))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!opts.streamPath.empty())
+    {
+        auto t0 = high_resolution_clock::now();
+        if (!streamEllerMaze(opts.streamPath, opts.rows, opts.cols, opts.seed))
+        {
+            cerr << "failed to write " << opts.streamPath << "\n";
+            return 1;
+        }
+        double ms = duration<double, milli>(high_resolution_clock::now() - t0).count();
+        cout << fixed << setprecision(3)
+             << "streamed: " << opts.streamPath << " (" << opts.rows << "x" << opts.cols << ")\n"
+             << "time:     " << ms << " ms\n"
+             << "peak rss: " << peakRssMiB() << " MiB\n";
+        return 0;
+    }
+
+    if (!opts.loadPath.empty())
+    {
+        return loadMaze(opts.loadPath);
+    }
+    if (!opts.replayPaths.empty())
+    {
+        return replaySessions(opts.replayPaths);
+    }
+    if (opts.levels > 0)
+    {
+        return runLayered(opts);
+    }
+
+    auto runStarted = steady_clock::now();
+    auto runMs = [&runStarted]() {
+        return static_cast<uint32_t>(duration_cast<milliseconds>(steady_clock::now() - runStarted).count());
+    };
+    InputRecorder recorder;
+    if (!opts.recordPath.empty() && !recorder.open(opts.recordPath))
+    {
+        cerr << "cannot open " << opts.recordPath << "\n";
+        return 1;
+    }
+
+    const int dx[] = {-1, 1, 0, 0};
+    const int dy[] = {0, 0, -1, 1};
+
+    mt19937 moveGen(12345);
+    Maze maze;
+    maze.setNextHopTable(opts.nextHops);
+    maze.setDistanceThreads(opts.distanceThreads);
+    double initMs = 0.0;
+    double moveMs = 0.0;
+    long long moves = 0;
+    // Allocations in maze init after the first maze, and in every move.
+    long long initAllocs = 0;
+    long long moveAllocs = 0;
+
+    struct SolverTotals
+    {
+        double ms = 0.0;
+        long long nodes = 0;
+        long long mismatches = 0;
+        long long lostInLoops = 0;
+    };
+    vector<SolverTotals> solverTotals(opts.solvers.size());
+    vector<pair<int, int>> path;
+
+    for (int r = 0; r < opts.repeat; r++)
+    {
+        long long allocsBefore = allocationCount.load(memory_order_relaxed);
+        auto t0 = high_resolution_clock::now();
+        if (opts.hasId)
+        {
+            maze.init(opts.id);
+        }
+        else if (opts.rows > 0 && opts.hasSeed)
+        {
+            maze.init(opts.rows, opts.cols, opts.generator, opts.seed + r, opts.braid);
+        }
+        else if (opts.rows > 0)
+        {
+            maze.init(opts.rows, opts.cols, opts.generator, Maze::randomSeed(), opts.braid);
+        }
+        else if (opts.hasSeed)
+        {
+            maze.init(opts.difficulty, opts.seed + r);
+        }
+        else
+        {
+            maze.init(opts.difficulty);
+        }
+        auto t1 = high_resolution_clock::now();
+        initMs += duration<double, milli>(t1 - t0).count();
+        if (r > 0)
+        {
+            initAllocs += allocationCount.load(memory_order_relaxed) - allocsBefore;
+        }
+        recorder.beginSession(maze.getId(), runMs());
+
+        for (size_t s = 0; s < opts.solvers.size(); s++)
+        {
+            SolveStats stats;
+            maze.setSolver(opts.solvers[s]);
+            bool found = maze.solve(path, stats);
+            solverTotals[s].ms += stats.wallMs;
+            solverTotals[s].nodes += stats.nodesExpanded;
+
+            // A solver that is not shortest-path (the wall follower) may
+            // circle an island of a braided maze forever; that is expected.
+            bool shortest = static_cast<int>(path.size()) == maze.getOptimalPathLength();
+            if (makeSolver(opts.solvers[s])->isShortest() ? !found || !shortest : !found && maze.getId().braid == 0)
+            {
+                solverTotals[s].mismatches++;
+            }
+            else if (!found)
+            {
+                solverTotals[s].lostInLoops++;
+            }
+        }
+
+        for (int m = 0; m < opts.randomMoves && !maze.isCompleted(); m++)
+        {
+            int dir = moveGen() % 4;
+            recorder.record({runMs(), static_cast<Command>(dir)});
+            long long m0Allocs = allocationCount.load(memory_order_relaxed);
+            auto m0 = high_resolution_clock::now();
+            maze.movePlayer(dx[dir], dy[dir]);
+            moveMs += duration<double, milli>(high_resolution_clock::now() - m0).count();
+            moveAllocs += allocationCount.load(memory_order_relaxed) - m0Allocs;
+            moves++;
+        }
+
+        if (opts.solve)
+        {
+            while (!maze.isCompleted() && maze.getRemainingDistance() > 0)
+            {
+                const auto &pos = maze.getPlayerPosition();
+                auto next = maze.getNextStep();
+                int dir = next.first < pos.first ? 0 : next.first > pos.first ? 1 : next.second < pos.second ? 2 : 3;
+                recorder.record({runMs(), static_cast<Command>(dir)});
+                long long m0Allocs = allocationCount.load(memory_order_relaxed);
+                auto m0 = high_resolution_clock::now();
+                maze.movePlayer(next.first - pos.first, next.second - pos.second);
+                moveMs += duration<double, milli>(high_resolution_clock::now() - m0).count();
+                moveAllocs += allocationCount.load(memory_order_relaxed) - m0Allocs;
+                moves++;
+            }
+        }
+    }
+
+    if (opts.print)
+    {
+        printMaze(maze);
+    }
+    if (!opts.profileJson.empty())
+    {
+        ofstream profile(opts.profileJson);
+        profiler::writeJson(profile);
+    }
+    if (!opts.savePath.empty() && !writeMazeFile(opts.savePath, maze, opts.saveDistances))
+    {
+        cerr << "failed to write " << opts.savePath << "\n";
+        return 1;
+    }
+
+    cout << fixed << setprecision(3)
+         << "mazes: " << opts.repeat << " (" << maze.getRows() << "x" << maze.getCols() << ")\n"
+         << "id:    " << maze.getId().toString() << (opts.repeat > 1 ? " (last)" : "") << "\n"
+         << "init:  " << initMs / opts.repeat << " ms/maze\n"
+         << "moves: " << moves;
+    if (moves > 0)
+    {
+        cout << " (" << moveMs * 1000.0 / moves << " us/move)";
+    }
+    cout << "\n"
+         << "allocs: " << moveAllocs << " in moves";
+    if (opts.repeat > 1)
+    {
+        cout << ", " << static_cast<double>(initAllocs) / (opts.repeat - 1) << " per init after the first";
+    }
+    cout << "\n";
+    for (size_t s = 0; s < opts.solvers.size(); s++)
+    {
+        cout << "solver " << left << setw(14) << solverName(opts.solvers[s]) << right
+             << solverTotals[s].ms / opts.repeat << " ms/solve, "
+             << solverTotals[s].nodes / opts.repeat << " nodes/solve";
+        if (solverTotals[s].mismatches > 0)
+        {
+            cout << ", " << solverTotals[s].mismatches << " wrong";
+        }
+        if (solverTotals[s].lostInLoops > 0)
+        {
+            cout << ", " << solverTotals[s].lostInLoops << " lost in loops";
+        }
+        cout << "\n";
+    }
+    cout << "optimal path: " << maze.getOptimalPathLength() << " steps\n"
+         << "completed: " << (maze.isCompleted() ? "yes" : "no") << "\n"
+         << "peak rss: " << peakRssMiB() << " MiB\n";
+
+    for (const SolverTotals &totals : solverTotals)
+    {
+        if (totals.mismatches > 0)
+        {
+            cerr << "a solver found no path or a longer one than it should\n";
+            return 1;
+        }
+    }
+
+    // Moves never allocate, and every maze after the first is the same size,
+    // so by then generation has all the scratch memory it needs.
+    if (moveAllocs > 0 || initAllocs > 0)
+    {
+        cerr << "allocation regression: " << moveAllocs << " in moves, " << initAllocs
+             << " in init after the first maze\n";
+        return 1;
+    }
+    return 0;
+}
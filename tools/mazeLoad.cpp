@@ -0,0 +1,471 @@
+// Load generator for mazeServer. Opens many sessions, starts a maze on each
+// and then sends random moves, either as fast as the server answers (one
+// request in flight per session) or at a fixed total rate. Latency is measured
+// from the moment a move was due to be sent until its reply arrives, so a
+// client that falls behind its schedule shows up in the numbers too; the
+// round trip from the actual send is reported next to it.
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "core/MazeSession.h"
+#include "core/Random.h"
+
+using namespace std;
+using namespace chrono;
+
+struct Options
+{
+    string unixPath;
+    int port = 0;
+    int sessions = 10000;
+    unsigned threads = 1;
+    double seconds = 10.0;
+    double rate = 0.0;
+    Difficulty difficulty = Difficulty::HARD;
+    uint64_t seed = 1;
+};
+
+struct Client
+{
+    int fd = -1;
+    bool busy = false;
+    bool timed = false;
+    int64_t dueNs = 0;
+    int64_t sentNs = 0;
+    uint16_t sequence = 0;
+    uint8_t reply[sizeof(SessionReply)];
+    size_t replySize = 0;
+};
+
+struct ThreadResult
+{
+    vector<uint32_t> latencyNs;
+    vector<uint32_t> roundTripNs;
+    long long errors = 0;
+    long long behind = 0; // send slots that found every session still waiting
+};
+
+// CLOCK_MONOTONIC, the clock the pacing timer runs on.
+static int64_t nowNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+static int connectTo(const Options &opts)
+{
+    int fd;
+    if (!opts.unixPath.empty())
+    {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, opts.unixPath.c_str(), sizeof(addr.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+        {
+            if (fd >= 0)
+                close(fd);
+            return -1;
+        }
+    }
+    else
+    {
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(opts.port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+        {
+            if (fd >= 0)
+                close(fd);
+            return -1;
+        }
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+static bool sendRequest(Client &client, const SessionRequest &request)
+{
+    uint8_t bytes[SESSION_REQUEST_MAX];
+    size_t length = encodeRequest(request, bytes);
+    // Requests are tiny and only one is in flight, so the socket buffer always has room.
+    if (send(client.fd, bytes, length, MSG_NOSIGNAL) != static_cast<ssize_t>(length))
+    {
+        return false;
+    }
+    client.busy = true;
+    client.replySize = 0;
+    client.sentNs = nowNs();
+    return true;
+}
+
+static bool sendMove(Client &client, Xoshiro256 &gen, int64_t dueNs)
+{
+    SessionRequest request;
+    request.type = RequestType::COMMAND;
+    request.argument = static_cast<uint8_t>(gen.below(4));
+    request.sequence = ++client.sequence;
+    client.dueNs = dueNs;
+    client.timed = true;
+    return sendRequest(client, request);
+}
+
+// Reads whatever part of the reply has arrived. Returns 1 once the reply is
+// complete, 0 if more is to come and -1 on errors.
+static int readReply(Client &client)
+{
+    ssize_t n = recv(client.fd, client.reply + client.replySize, sizeof(client.reply) - client.replySize, 0);
+    if (n <= 0)
+    {
+        return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+    client.replySize += static_cast<size_t>(n);
+    if (client.replySize < sizeof(client.reply))
+    {
+        return 0;
+    }
+    SessionReply reply;
+    memcpy(&reply, client.reply, sizeof(reply));
+    client.busy = false;
+    return reply.status == REPLY_OK && reply.sequence == client.sequence ? 1 : -1;
+}
+
+static void runClients(const Options &opts, vector<Client> &clients, size_t firstSession, int64_t startNs,
+                       int64_t endNs, ThreadResult &result)
+{
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    for (size_t i = 0; i < clients.size(); i++)
+    {
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u64 = i;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, clients[i].fd, &event);
+    }
+
+    Xoshiro256 gen(opts.seed ^ (firstSession * 0x9e3779b97f4a7c15ULL));
+    double perThreadRate = opts.rate / opts.threads;
+    int64_t intervalNs = perThreadRate > 0 ? static_cast<int64_t>(1e9 / perThreadRate) : 0;
+    int64_t nextDue = startNs;
+    size_t nextClient = 0;
+
+    // Paced sends wake up on an absolute timer; epoll timeouts only have
+    // millisecond resolution, which would show up as latency.
+    const uint64_t TIMER = UINT64_MAX;
+    int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    epoll_event timerEvent;
+    timerEvent.events = EPOLLIN;
+    timerEvent.data.u64 = TIMER;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &timerEvent);
+
+    // Closed loop: every session starts with one move in flight.
+    if (intervalNs == 0)
+    {
+        for (Client &client : clients)
+        {
+            if (!sendMove(client, gen, nowNs()))
+                result.errors++;
+        }
+    }
+
+    epoll_event events[256];
+    while (true)
+    {
+        int64_t now = nowNs();
+        if (now >= endNs)
+        {
+            break;
+        }
+
+        int timeoutMs = 100;
+        if (intervalNs > 0)
+        {
+            for (; nextDue <= now; nextDue += intervalNs)
+            {
+                size_t tried = 0;
+                while (clients[nextClient].busy && tried < clients.size())
+                {
+                    nextClient = (nextClient + 1) % clients.size();
+                    tried++;
+                }
+                if (tried == clients.size())
+                {
+                    result.behind++;
+                    continue;
+                }
+                if (!sendMove(clients[nextClient], gen, nextDue))
+                    result.errors++;
+                nextClient = (nextClient + 1) % clients.size();
+            }
+            itimerspec due = {};
+            due.it_value.tv_sec = static_cast<time_t>(nextDue / 1000000000);
+            due.it_value.tv_nsec = static_cast<long>(nextDue % 1000000000);
+            timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &due, nullptr);
+        }
+
+        int n = epoll_wait(epollFd, events, 256, timeoutMs);
+        for (int i = 0; i < n; i++)
+        {
+            if (events[i].data.u64 == TIMER)
+            {
+                uint64_t expirations;
+                if (read(timerFd, &expirations, sizeof(expirations)) < 0)
+                {
+                    // Already re-armed or not yet due; the loop checks the time anyway.
+                }
+                continue;
+            }
+            Client &client = clients[events[i].data.u64];
+            int status = readReply(client);
+            if (status == 0)
+            {
+                continue;
+            }
+            int64_t received = nowNs();
+            if (status < 0)
+            {
+                result.errors++;
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, client.fd, nullptr);
+                client.busy = true; // never schedule it again
+                continue;
+            }
+            if (client.timed)
+            {
+                result.latencyNs.push_back(static_cast<uint32_t>(min<int64_t>(received - client.dueNs, UINT32_MAX)));
+                result.roundTripNs.push_back(static_cast<uint32_t>(min<int64_t>(received - client.sentNs, UINT32_MAX)));
+            }
+            if (intervalNs == 0 && received < endNs && !sendMove(client, gen, received))
+            {
+                result.errors++;
+            }
+        }
+    }
+    close(timerFd);
+    close(epollFd);
+}
+
+// Starts a maze on every session and waits for all replies.
+static bool startMazes(const Options &opts, vector<Client> &clients, size_t firstSession)
+{
+    for (size_t i = 0; i < clients.size(); i++)
+    {
+        SessionRequest request;
+        request.type = RequestType::NEW_MAZE;
+        request.argument = static_cast<uint8_t>(opts.difficulty);
+        request.seed = opts.seed + firstSession + i;
+        request.sequence = ++clients[i].sequence;
+        clients[i].timed = false;
+        if (!sendRequest(clients[i], request))
+        {
+            return false;
+        }
+    }
+    for (Client &client : clients)
+    {
+        int status;
+        do
+        {
+            pollfd wait = {client.fd, POLLIN, 0};
+            poll(&wait, 1, 1000);
+            status = readReply(client);
+        } while (status == 0);
+        if (status < 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void printLatency(const char *label, vector<uint32_t> &latency)
+{
+    if (latency.empty())
+    {
+        return;
+    }
+    sort(latency.begin(), latency.end());
+    auto percentile = [&latency](double p) {
+        return latency[min(latency.size() - 1, static_cast<size_t>(p * latency.size()))] / 1000.0;
+    };
+    cout << label << " p50 " << percentile(0.50) << " us, p90 " << percentile(0.90) << " us, p99 "
+         << percentile(0.99) << " us, p99.9 " << percentile(0.999) << " us, max " << latency.back() / 1000.0
+         << " us\n";
+}
+
+static void printUsage(const char *argv0)
+{
+    cout << "Usage: " << argv0 << " (--unix PATH | --port N) [options]\n"
+         << "  --unix PATH                    connect to a Unix domain socket\n"
+         << "  --port N                       connect to TCP 127.0.0.1:N\n"
+         << "  --sessions N                   concurrent sessions (default 10000)\n"
+         << "  --threads T                    client threads (default 1)\n"
+         << "  --seconds S                    length of the timed run (default 10)\n"
+         << "  --rate R                       total moves per second; 0 sends the next move\n"
+         << "                                 as soon as a session's reply arrives (default 0)\n"
+         << "  --difficulty easy|medium|hard  maze played by every session (default hard)\n"
+         << "  --seed S                       session i plays the maze with seed S + i (default 1)\n";
+}
+
+static bool parseOptions(int argc, char **argv, Options &opts)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--unix" && hasValue)
+            opts.unixPath = argv[++i];
+        else if (arg == "--port" && hasValue)
+            opts.port = atoi(argv[++i]);
+        else if (arg == "--sessions" && hasValue)
+            opts.sessions = atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue)
+            opts.threads = static_cast<unsigned>(atoi(argv[++i]));
+        else if (arg == "--seconds" && hasValue)
+            opts.seconds = atof(argv[++i]);
+        else if (arg == "--rate" && hasValue)
+            opts.rate = atof(argv[++i]);
+        else if (arg == "--seed" && hasValue)
+            opts.seed = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--difficulty" && hasValue)
+        {
+            string value = argv[++i];
+            if (value == "easy")
+                opts.difficulty = Difficulty::EASY;
+            else if (value == "medium")
+                opts.difficulty = Difficulty::MEDIUM;
+            else if (value == "hard")
+                opts.difficulty = Difficulty::HARD;
+            else
+                return false;
+        }
+        else
+            return false;
+    }
+    return opts.unixPath.empty() != (opts.port <= 0) && opts.sessions > 0 && opts.threads > 0 &&
+           opts.threads <= static_cast<unsigned>(opts.sessions) && opts.seconds > 0 && opts.rate >= 0;
+}
+
+int main(int argc, char **argv)
+{
+    Options opts;
+    if (!parseOptions(argc, argv, opts))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Timer wake-ups are part of the measured latency; don't let the kernel
+    // batch them (the default slack is 50 us).
+    prctl(PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL);
+
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    // Sessions are dealt out to the threads in contiguous blocks.
+    vector<vector<Client>> perThread(opts.threads);
+    vector<size_t> firstSession(opts.threads);
+    auto connectStarted = steady_clock::now();
+    for (unsigned t = 0; t < opts.threads; t++)
+    {
+        size_t begin = static_cast<size_t>(opts.sessions) * t / opts.threads;
+        size_t end = static_cast<size_t>(opts.sessions) * (t + 1) / opts.threads;
+        firstSession[t] = begin;
+        perThread[t].resize(end - begin);
+        for (Client &client : perThread[t])
+        {
+            client.fd = connectTo(opts);
+            if (client.fd < 0)
+            {
+                cerr << "cannot connect session " << begin << ": " << strerror(errno) << "\n";
+                return 1;
+            }
+        }
+        if (!startMazes(opts, perThread[t], begin))
+        {
+            cerr << "cannot start mazes\n";
+            return 1;
+        }
+    }
+    double connectMs = duration<double, milli>(steady_clock::now() - connectStarted).count();
+
+    vector<ThreadResult> results(opts.threads);
+    vector<thread> threads;
+    int64_t startNs = nowNs();
+    int64_t endNs = startNs + static_cast<int64_t>(opts.seconds * 1e9);
+    for (unsigned t = 0; t < opts.threads; t++)
+    {
+        threads.emplace_back(runClients, cref(opts), ref(perThread[t]), firstSession[t], startNs, endNs,
+                             ref(results[t]));
+    }
+    for (thread &t : threads)
+    {
+        t.join();
+    }
+    double seconds = (nowNs() - startNs) / 1e9;
+
+    vector<uint32_t> latency;
+    vector<uint32_t> roundTrip;
+    long long errors = 0;
+    long long behind = 0;
+    for (const ThreadResult &result : results)
+    {
+        latency.insert(latency.end(), result.latencyNs.begin(), result.latencyNs.end());
+        roundTrip.insert(roundTrip.end(), result.roundTripNs.begin(), result.roundTripNs.end());
+        errors += result.errors;
+        behind += result.behind;
+    }
+    for (vector<Client> &clients : perThread)
+    {
+        for (Client &client : clients)
+        {
+            close(client.fd);
+        }
+    }
+
+    cout << fixed << setprecision(1) << "sessions: " << opts.sessions << " (connected and started in "
+         << connectMs << " ms)\n"
+         << "moves:    " << latency.size() << " (" << latency.size() / seconds << "/s)\n";
+    printLatency("latency: ", latency);
+    printLatency("sent:    ", roundTrip);
+    if (behind > 0)
+    {
+        cout << "behind:   " << behind << " send slots found every session waiting\n";
+    }
+    if (errors > 0)
+    {
+        cout << "errors:   " << errors << "\n";
+    }
+    return errors > 0 ? 1 : 0;
+}
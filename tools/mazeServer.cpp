@@ -0,0 +1,407 @@
+// Multi-session maze server for Linux. Every connection is one player with its
+// own MazeSession. Connections are spread over a fixed set of worker threads,
+// each running its own epoll loop, so a session is only ever touched by the
+// worker that owns it and nothing is shared or locked on the request path.
+// The wire protocol is described in core/MazeSession.h.
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "core/MazeSession.h"
+#include "core/Profiler.h"
+
+using namespace std;
+using namespace chrono;
+
+static atomic<bool> running{true};
+
+static void stopServer(int)
+{
+    running = false;
+}
+
+struct Options
+{
+    string unixPath;
+    int port = 0;
+    unsigned threads = 0;
+    string profileJson;
+};
+
+// A client connection. Requests are at most SESSION_REQUEST_MAX bytes, so a
+// small input buffer is enough; replies that could not be written right away
+// wait in pending until the socket drains.
+struct Connection
+{
+    int fd;
+    MazeSession session;
+    uint8_t input[256];
+    size_t inputSize = 0;
+    vector<uint8_t> pending;
+    size_t pendingPos = 0;
+
+    explicit Connection(int fd) : fd(fd) {}
+};
+
+class Worker
+{
+private:
+    int epollFd;
+    thread loop;
+    atomic<long long> requests;
+    atomic<long long> sessions;
+
+    void closeConnection(Connection *connection)
+    {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, connection->fd, nullptr);
+        close(connection->fd);
+        delete connection;
+        sessions.fetch_sub(1, memory_order_relaxed);
+    }
+
+    void watch(Connection *connection, uint32_t events)
+    {
+        epoll_event event;
+        event.events = events;
+        event.data.ptr = connection;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, connection->fd, &event);
+    }
+
+    // Sends what is left of pending. Returns false if the connection failed.
+    bool flush(Connection *connection)
+    {
+        while (connection->pendingPos < connection->pending.size())
+        {
+            ssize_t n = send(connection->fd, connection->pending.data() + connection->pendingPos,
+                             connection->pending.size() - connection->pendingPos, MSG_NOSIGNAL);
+            if (n < 0)
+            {
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            connection->pendingPos += static_cast<size_t>(n);
+        }
+        connection->pending.clear();
+        connection->pendingPos = 0;
+        watch(connection, EPOLLIN | EPOLLRDHUP);
+        return true;
+    }
+
+    // Reads once, answers every complete request and writes the replies in one
+    // send. Returns false when the connection should be closed.
+    bool serve(Connection *connection)
+    {
+        ssize_t n = recv(connection->fd, connection->input + connection->inputSize,
+                         sizeof(connection->input) - connection->inputSize, 0);
+        if (n <= 0)
+        {
+            return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+        connection->inputSize += static_cast<size_t>(n);
+
+        SessionReply replies[sizeof(connection->input) / SESSION_REQUEST_HEADER];
+        size_t count = 0;
+        size_t pos = 0;
+        while (true)
+        {
+            SessionRequest request;
+            int length = decodeRequest(connection->input + pos, connection->inputSize - pos, request);
+            if (length < 0)
+            {
+                return false;
+            }
+            if (length == 0)
+            {
+                break;
+            }
+            connection->session.handle(request, replies[count++]);
+            pos += static_cast<size_t>(length);
+        }
+        memmove(connection->input, connection->input + pos, connection->inputSize - pos);
+        connection->inputSize -= pos;
+        requests.fetch_add(static_cast<long long>(count), memory_order_relaxed);
+
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(replies);
+        size_t size = count * sizeof(SessionReply);
+        ssize_t sent = size > 0 ? send(connection->fd, bytes, size, MSG_NOSIGNAL) : 0;
+        if (sent < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                return false;
+            }
+            sent = 0;
+        }
+        if (static_cast<size_t>(sent) < size)
+        {
+            // Stop reading until the client has taken its replies.
+            connection->pending.assign(bytes + sent, bytes + size);
+            connection->pendingPos = 0;
+            watch(connection, EPOLLOUT | EPOLLRDHUP);
+        }
+        return true;
+    }
+
+    void run()
+    {
+        epoll_event events[256];
+        while (running)
+        {
+            int n = epoll_wait(epollFd, events, 256, 100);
+            for (int i = 0; i < n; i++)
+            {
+                Connection *connection = static_cast<Connection *>(events[i].data.ptr);
+                bool ok = !(events[i].events & (EPOLLERR | EPOLLHUP));
+                if (ok && (events[i].events & EPOLLOUT))
+                {
+                    ok = flush(connection);
+                }
+                else if (ok && (events[i].events & (EPOLLIN | EPOLLRDHUP)))
+                {
+                    ok = serve(connection);
+                }
+                if (!ok)
+                {
+                    closeConnection(connection);
+                }
+            }
+        }
+    }
+
+public:
+    Worker() : epollFd(epoll_create1(EPOLL_CLOEXEC)), requests(0), sessions(0) {}
+
+    ~Worker()
+    {
+        if (loop.joinable())
+        {
+            loop.join();
+        }
+        close(epollFd);
+    }
+
+    void start()
+    {
+        loop = thread([this]() { run(); });
+    }
+
+    void join()
+    {
+        loop.join();
+    }
+
+    // Hands a freshly accepted socket to this worker. epoll_ctl is safe to call
+    // from the accepting thread while the worker waits.
+    bool adopt(int fd)
+    {
+        Connection *connection = new Connection(fd);
+        epoll_event event;
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.ptr = connection;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+            delete connection;
+            return false;
+        }
+        sessions.fetch_add(1, memory_order_relaxed);
+        return true;
+    }
+
+    long long getRequests() const { return requests.load(memory_order_relaxed); }
+    long long getSessions() const { return sessions.load(memory_order_relaxed); }
+};
+
+static void printUsage(const char *argv0)
+{
+    cout << "Usage: " << argv0 << " (--unix PATH | --port N) [options]\n"
+         << "  --unix PATH                    listen on a Unix domain socket\n"
+         << "  --port N                       listen on TCP 127.0.0.1:N\n"
+         << "  --threads T                    worker threads (default: all cores)\n"
+         << "  --profile-json FILE            write request timings on exit (profiling builds)\n";
+}
+
+static bool parseOptions(int argc, char **argv, Options &opts)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--unix" && hasValue)
+            opts.unixPath = argv[++i];
+        else if (arg == "--port" && hasValue)
+            opts.port = atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue)
+            opts.threads = static_cast<unsigned>(atoi(argv[++i]));
+        else if (arg == "--profile-json" && hasValue)
+            opts.profileJson = argv[++i];
+        else
+            return false;
+    }
+    return opts.unixPath.empty() != (opts.port <= 0) && opts.port < 65536;
+}
+
+static int listenOn(const Options &opts)
+{
+    int fd;
+    if (!opts.unixPath.empty())
+    {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (opts.unixPath.size() >= sizeof(addr.sun_path))
+        {
+            return -1;
+        }
+        strcpy(addr.sun_path, opts.unixPath.c_str());
+        unlink(addr.sun_path);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(opts.port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int on = 1;
+        if (fd < 0 || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 ||
+            bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+        {
+            return -1;
+        }
+    }
+    return listen(fd, SOMAXCONN) == 0 ? fd : -1;
+}
+
+// Lets one process hold as many sockets as the hard limit allows.
+static void raiseFileLimit()
+{
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options opts;
+    if (!parseOptions(argc, argv, opts))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    raiseFileLimit();
+    signal(SIGINT, stopServer);
+    signal(SIGTERM, stopServer);
+    signal(SIGPIPE, SIG_IGN);
+
+    int listenFd = listenOn(opts);
+    if (listenFd < 0)
+    {
+        cerr << "cannot listen: " << strerror(errno) << "\n";
+        return 1;
+    }
+
+    unsigned threads = opts.threads > 0 ? opts.threads : max(1u, thread::hardware_concurrency());
+    vector<Worker> workers(threads);
+    for (Worker &worker : workers)
+    {
+        worker.start();
+    }
+    cout << "listening on " << (opts.unixPath.empty() ? "127.0.0.1:" + to_string(opts.port) : opts.unixPath)
+         << " with " << threads << " worker" << (threads == 1 ? "" : "s") << "\n"
+         << flush;
+
+    auto started = steady_clock::now();
+    long long accepted = 0;
+    long long peakSessions = 0;
+    size_t next = 0;
+    pollfd listening = {listenFd, POLLIN, 0};
+    while (running)
+    {
+        if (poll(&listening, 1, 100) <= 0)
+        {
+            continue;
+        }
+        while (true)
+        {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+            {
+                break;
+            }
+            if (opts.unixPath.empty())
+            {
+                int on = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            }
+            if (!workers[next].adopt(fd))
+            {
+                close(fd);
+                continue;
+            }
+            next = (next + 1) % workers.size();
+            accepted++;
+        }
+
+        long long live = 0;
+        for (const Worker &worker : workers)
+        {
+            live += worker.getSessions();
+        }
+        peakSessions = max(peakSessions, live);
+    }
+
+    for (Worker &worker : workers)
+    {
+        worker.join();
+    }
+    close(listenFd);
+    if (!opts.unixPath.empty())
+    {
+        unlink(opts.unixPath.c_str());
+    }
+
+    long long requests = 0;
+    for (const Worker &worker : workers)
+    {
+        requests += worker.getRequests();
+    }
+    double seconds = duration<double>(steady_clock::now() - started).count();
+    cout << fixed << setprecision(1) << "sessions: " << accepted << " (peak " << peakSessions << " at once)\n"
+         << "requests: " << requests << " (" << requests / seconds << "/s over " << seconds << " s)\n";
+
+    if (!opts.profileJson.empty())
+    {
+        ofstream profile(opts.profileJson);
+        profiler::writeJson(profile);
+    }
+    return 0;
+}
@@ -0,0 +1,567 @@
+// Terminal front end for Linux and macOS: the same game as mazeRunner.cpp,
+// drawn with ANSI escape sequences. Every frame is composed in a FrameBuffer,
+// only the changed cells are encoded by AnsiTerminal, and the result goes out
+// in a single write() - which keeps it responsive over SSH.
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <termios.h>
+#include <unistd.h>
+
+#include "core/AnsiTerminal.h"
+#include "core/FrameBuffer.h"
+#include "core/InputLog.h"
+#include "core/LayeredMaze.h"
+#include "core/Maze.h"
+#include "core/Profiler.h"
+#include "core/ScoreStore.h"
+
+using namespace std;
+
+// Puts the terminal into raw mode for the lifetime of the object.
+class RawMode
+{
+private:
+    termios saved;
+    bool active;
+
+public:
+    RawMode() : active(false)
+    {
+        if (tcgetattr(STDIN_FILENO, &saved) == 0)
+        {
+            termios raw = saved;
+            raw.c_lflag &= ~(ICANON | ECHO);
+            raw.c_cc[VMIN] = 1;
+            raw.c_cc[VTIME] = 0;
+            active = tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) == 0;
+        }
+    }
+
+    ~RawMode()
+    {
+        if (active)
+        {
+            tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved);
+        }
+    }
+};
+
+static Command readCommand()
+{
+    char c;
+    if (read(STDIN_FILENO, &c, 1) != 1)
+    {
+        return Command::QUIT;
+    }
+    if (c == '\x1b')
+    {
+        // Arrow keys arrive as ESC [ A..D.
+        char seq[2];
+        if (read(STDIN_FILENO, &seq[0], 1) != 1 || read(STDIN_FILENO, &seq[1], 1) != 1 || seq[0] != '[')
+        {
+            return Command::NONE;
+        }
+        switch (seq[1])
+        {
+        case 'A':
+            return Command::MOVE_UP;
+        case 'B':
+            return Command::MOVE_DOWN;
+        case 'C':
+            return Command::MOVE_RIGHT;
+        case 'D':
+            return Command::MOVE_LEFT;
+        default:
+            return Command::NONE;
+        }
+    }
+
+    switch (tolower(c))
+    {
+    case 'w':
+        return Command::MOVE_UP;
+    case 's':
+        return Command::MOVE_DOWN;
+    case 'a':
+        return Command::MOVE_LEFT;
+    case 'd':
+        return Command::MOVE_RIGHT;
+    case 'f':
+        return Command::TOGGLE_SOLUTION;
+    case 'c':
+        return Command::CLEAR_TRAIL;
+    case 'r':
+        return Command::RESTART;
+    case 'n':
+        return Command::NEW_MAZE;
+    case 'p':
+        return Command::PROFILE;
+    case 'q':
+        return Command::QUIT;
+    case '<':
+    case ',':
+        return Command::ASCEND;
+    case '>':
+    case '.':
+        return Command::DESCEND;
+    default:
+        return Command::NONE;
+    }
+}
+
+// Keyboard input, stamped with the time since the program started.
+class TerminalInput : public InputSource
+{
+private:
+    chrono::steady_clock::time_point started;
+
+public:
+    TerminalInput() : started(chrono::steady_clock::now()) {}
+
+    uint32_t elapsedMs() const
+    {
+        return static_cast<uint32_t>(
+            chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - started).count());
+    }
+
+    bool next(InputEvent &event) override
+    {
+        event.command = readCommand();
+        event.atMs = elapsedMs();
+        return true;
+    }
+};
+
+static void composeFrame(const Maze &maze, const string &scoreLine, bool showProfile, FrameBuffer &frame)
+{
+    MAZE_PROFILE_SCOPE("compose");
+    const int startX = 2;
+    const int startY = 1;
+    int panelX = startX + maze.getCols() + 3;
+    int height = startY + max(maze.getRows(), 16) + 1;
+
+    vector<string> overlay;
+    if (showProfile)
+    {
+        overlay = profiler::overlayLines();
+    }
+    frame.resize(panelX + 34, height + static_cast<int>(overlay.size()));
+    frame.clear();
+    for (size_t i = 0; i < overlay.size(); i++)
+    {
+        frame.text(startX, height + static_cast<int>(i), overlay[i], ConsoleColor::DARKGRAY);
+    }
+
+    for (int i = 0; i < maze.getRows(); i++)
+    {
+        for (int j = 0; j < maze.getCols(); j++)
+        {
+            CellView view = maze.cellView(i, j);
+            frame.put(startX + j, startY + i, Maze::glyph(view), Maze::color(view));
+        }
+    }
+
+    ostringstream time;
+    time << fixed << setprecision(1) << maze.getElapsedTime();
+
+    frame.text(panelX, startY, "P - Player   E - Exit", ConsoleColor::LIGHTGREEN);
+    frame.text(panelX, startY + 1, ". - Trail    + - Solution", ConsoleColor::YELLOW);
+    frame.text(panelX, startY + 3, "Time: " + time.str() + "s", ConsoleColor::WHITE);
+    frame.text(panelX, startY + 4, "Path: " + to_string(maze.getPathLength()) + " steps", ConsoleColor::WHITE);
+    frame.text(panelX, startY + 5, "Optimal: " + to_string(maze.getOptimalPathLength()) + " steps",
+               ConsoleColor::WHITE);
+    frame.text(panelX, startY + 6, "To exit: " + to_string(maze.getRemainingDistance()) + " steps",
+               ConsoleColor::WHITE);
+    frame.text(panelX, startY + 7, "ID: " + maze.getId().toString(), ConsoleColor::WHITE);
+
+    const char *controls[] = {"WASD/Arrows - Move", "F - Show solution", "C - Clear trail",
+                              "R - Restart", "N - New maze",
+                              profiler::enabled() ? "P - Timings" : "P - Timings (disabled)", "Q - Quit"};
+    for (int i = 0; i < 7; i++)
+    {
+        frame.text(panelX, startY + 8 + i, controls[i], ConsoleColor::LIGHTCYAN);
+    }
+
+    if (maze.isCompleted())
+    {
+        frame.text(panelX, startY + 15, "MAZE COMPLETED! N or Q", ConsoleColor::YELLOW);
+        frame.text(panelX, startY + 16, scoreLine, ConsoleColor::LIGHTGREEN);
+    }
+}
+
+// A layered maze shows only the level the player is on.
+static void composeLayeredFrame(const LayeredMaze &maze, bool showProfile, FrameBuffer &frame)
+{
+    MAZE_PROFILE_SCOPE("compose");
+    const int startX = 2;
+    const int startY = 1;
+    int level = maze.getPlayerPosition().level;
+    int panelX = startX + maze.getCols() + 3;
+    int height = startY + max(maze.getRows(), 17) + 1;
+
+    vector<string> overlay;
+    if (showProfile)
+    {
+        overlay = profiler::overlayLines();
+    }
+    frame.resize(panelX + 34, height + static_cast<int>(overlay.size()));
+    frame.clear();
+    for (size_t i = 0; i < overlay.size(); i++)
+    {
+        frame.text(startX, height + static_cast<int>(i), overlay[i], ConsoleColor::DARKGRAY);
+    }
+
+    for (int i = 0; i < maze.getRows(); i++)
+    {
+        for (int j = 0; j < maze.getCols(); j++)
+        {
+            CellView view = maze.cellView(level, i, j);
+            frame.put(startX + j, startY + i, Maze::glyph(view), Maze::color(view));
+        }
+    }
+
+    ostringstream time;
+    time << fixed << setprecision(1) << maze.getElapsedTime();
+
+    frame.text(panelX, startY, "P - Player   E - Exit", ConsoleColor::LIGHTGREEN);
+    frame.text(panelX, startY + 1, ". - Trail    + - Solution", ConsoleColor::YELLOW);
+    frame.text(panelX, startY + 2, "< > X - Stairs up/down/both", ConsoleColor::LIGHTCYAN);
+    frame.text(panelX, startY + 4, "Level: " + to_string(level + 1) + " of " + to_string(maze.getLevels()),
+               ConsoleColor::WHITE);
+    frame.text(panelX, startY + 5, "Time: " + time.str() + "s", ConsoleColor::WHITE);
+    frame.text(panelX, startY + 6, "Path: " + to_string(maze.getPathLength()) + " steps", ConsoleColor::WHITE);
+    frame.text(panelX, startY + 7, "Optimal: " + to_string(maze.getOptimalPathLength()) + " steps",
+               ConsoleColor::WHITE);
+    frame.text(panelX, startY + 8, "To exit: " + to_string(maze.getRemainingDistance()) + " steps",
+               ConsoleColor::WHITE);
+
+    const char *controls[] = {"WASD/Arrows - Move", "< > - Take the stairs", "F - Show solution",
+                              "C - Clear trail", "R - Restart", "N - New maze", "Q - Quit"};
+    for (int i = 0; i < 7; i++)
+    {
+        frame.text(panelX, startY + 10 + i, controls[i], ConsoleColor::LIGHTCYAN);
+    }
+
+    if (maze.isCompleted())
+    {
+        frame.text(panelX, startY + 17, "MAZE COMPLETED! N or Q", ConsoleColor::YELLOW);
+    }
+}
+
+struct Options
+{
+    Difficulty difficulty = Difficulty::EASY;
+    int rows = 0;
+    int cols = 0;
+    Generator generator = Generator::DFS;
+    int braid = 0;
+    int levels = 0;
+    int stairs = LayeredMaze::DEFAULT_STAIRS_PERCENT;
+    MazeId id;
+    bool hasId = false;
+    string scores = "maze_scores.log";
+    string profileJson;
+    string record;
+};
+
+static void printUsage(const char *argv0)
+{
+    cout << "Usage: " << argv0 << " [options]\n"
+         << "  --difficulty easy|medium|hard  maze size (default easy)\n"
+         << "  --rows R --cols C              custom maze size instead of a difficulty\n"
+         << "  --generator NAME               carving algorithm for custom sizes: dfs (default),\n"
+         << "                                 backtrack, eller, kruskal, wilson, binarytree,\n"
+         << "                                 sidewinder or growingtree\n"
+         << "  --braid PERCENT                open this share of dead ends into loops (default 0)\n"
+         << "  --levels N                     play a maze of N levels joined by stairs, one level\n"
+         << "                                 on screen at a time (not scored or recorded)\n"
+         << "  --stairs PERCENT               how often the carver takes a stair (default 10)\n"
+         << "  --id ID                        play the maze with this ID\n"
+         << "  --scores FILE                  score log (default maze_scores.log)\n"
+         << "  --profile-json FILE            write hot-path timings on exit (profiling builds)\n"
+         << "  --record FILE                  append every maze played and its moves to FILE\n";
+}
+
+static bool parseOptions(int argc, char **argv, Options &opts)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            return false;
+        }
+        string value = argv[++i];
+
+        if (arg == "--difficulty")
+        {
+            if (value == "easy")
+                opts.difficulty = Difficulty::EASY;
+            else if (value == "medium")
+                opts.difficulty = Difficulty::MEDIUM;
+            else if (value == "hard")
+                opts.difficulty = Difficulty::HARD;
+            else
+                return false;
+        }
+        else if (arg == "--rows")
+            opts.rows = atoi(value.c_str());
+        else if (arg == "--cols")
+            opts.cols = atoi(value.c_str());
+        else if (arg == "--generator")
+        {
+            if (!parseGenerator(value, opts.generator))
+                return false;
+        }
+        else if (arg == "--braid")
+            opts.braid = atoi(value.c_str());
+        else if (arg == "--levels")
+            opts.levels = atoi(value.c_str());
+        else if (arg == "--stairs")
+            opts.stairs = atoi(value.c_str());
+        else if (arg == "--scores")
+            opts.scores = value;
+        else if (arg == "--profile-json")
+            opts.profileJson = value;
+        else if (arg == "--record")
+            opts.record = value;
+        else if (arg == "--id")
+        {
+            if (!MazeId::parse(value, opts.id))
+                return false;
+            opts.hasId = true;
+        }
+        else
+            return false;
+    }
+    return (opts.rows > 0) == (opts.cols > 0) && opts.braid >= 0 && opts.braid <= MAX_BRAID && opts.levels >= 0 &&
+           opts.levels <= LayeredMaze::MAX_LEVELS && opts.stairs >= 0 && opts.stairs <= 100;
+}
+
+// The game loop for layered mazes. Without --rows/--cols every level is the
+// size of the chosen difficulty.
+static int playLayered(const Options &opts)
+{
+    const int sizes[][2] = {{11, 19}, {15, 27}, {21, 39}};
+    int rows = opts.rows > 0 ? opts.rows : sizes[static_cast<int>(opts.difficulty)][0];
+    int cols = opts.cols > 0 ? opts.cols : sizes[static_cast<int>(opts.difficulty)][1];
+
+    TerminalInput input;
+    LayeredMaze maze;
+    maze.init(rows, cols, opts.levels, Maze::randomSeed(), opts.stairs);
+    bool showProfile = false;
+
+    RawMode raw;
+    AnsiTerminal terminal;
+    FrameBuffer frame;
+    terminal.useAlternateScreen(true);
+    terminal.showCursor(false);
+    terminal.clearScreen();
+
+    bool playing = true;
+    while (playing)
+    {
+        maze.updateTimer();
+        composeLayeredFrame(maze, showProfile, frame);
+        {
+            MAZE_PROFILE_SCOPE("present");
+            frame.present([&terminal](int x, int y, const char *text, int length, ConsoleColor color) {
+                terminal.write(x, y, text, length, color);
+            });
+            terminal.flush();
+        }
+
+        InputEvent event;
+        input.next(event);
+        MAZE_PROFILE_SCOPE("input");
+        switch (event.command)
+        {
+        case Command::MOVE_UP:
+            maze.move(LevelGrid::UP);
+            break;
+        case Command::MOVE_DOWN:
+            maze.move(LevelGrid::DOWN);
+            break;
+        case Command::MOVE_LEFT:
+            maze.move(LevelGrid::LEFT);
+            break;
+        case Command::MOVE_RIGHT:
+            maze.move(LevelGrid::RIGHT);
+            break;
+        case Command::ASCEND:
+            maze.move(LevelGrid::ASCEND);
+            break;
+        case Command::DESCEND:
+            maze.move(LevelGrid::DESCEND);
+            break;
+        case Command::TOGGLE_SOLUTION:
+            maze.toggleSolution();
+            break;
+        case Command::CLEAR_TRAIL:
+            maze.clearTrail();
+            break;
+        case Command::RESTART:
+            maze.restart();
+            break;
+        case Command::NEW_MAZE:
+            maze.init(rows, cols, opts.levels, Maze::randomSeed(), opts.stairs);
+            break;
+        case Command::PROFILE:
+            showProfile = !showProfile;
+            break;
+        case Command::QUIT:
+            playing = false;
+            break;
+        default:
+            break;
+        }
+    }
+
+    terminal.resetColor();
+    terminal.showCursor(true);
+    terminal.useAlternateScreen(false);
+    terminal.flush();
+
+    if (!opts.profileJson.empty())
+    {
+        ofstream profile(opts.profileJson);
+        profiler::writeJson(profile);
+    }
+
+    cout << "last maze: " << maze.getRows() << "x" << maze.getCols() << "x" << maze.getLevels() << ", seed "
+         << maze.getSeed() << " (" << terminal.getWriteCalls() << " writes, " << terminal.getBytesWritten()
+         << " bytes)\n";
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    Options opts;
+    if (!parseOptions(argc, argv, opts))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (opts.levels > 0)
+    {
+        return playLayered(opts);
+    }
+
+    TerminalInput input;
+    InputRecorder recorder;
+    if (!opts.record.empty() && !recorder.open(opts.record))
+    {
+        cerr << "cannot open " << opts.record << "\n";
+        return 1;
+    }
+
+    Maze maze;
+    maze.setNextHopTable(true);
+    auto newMaze = [&]() {
+        if (opts.hasId)
+            maze.init(opts.id);
+        else if (opts.rows > 0)
+            maze.init(opts.rows, opts.cols, opts.generator, Maze::randomSeed(), opts.braid);
+        else
+            maze.init(opts.difficulty);
+        recorder.beginSession(maze.getId(), input.elapsedMs());
+    };
+    newMaze();
+
+    ScoreStore scores;
+    if (!scores.open(opts.scores))
+    {
+        cerr << "cannot open score log " << opts.scores << "\n";
+    }
+    bool recorded = false;
+    string scoreLine;
+    bool showProfile = false;
+
+    RawMode raw;
+    AnsiTerminal terminal;
+    FrameBuffer frame;
+    terminal.useAlternateScreen(true);
+    terminal.showCursor(false);
+    terminal.clearScreen();
+
+    bool playing = true;
+    while (playing)
+    {
+        maze.updateTimer();
+        if (maze.isCompleted() && !recorded)
+        {
+            // Ranked against everyone who played this exact maze.
+            ScoreRecord score;
+            score.id = maze.getId();
+            score.difficulty = opts.rows > 0 || opts.hasId ? NO_DIFFICULTY : static_cast<uint8_t>(opts.difficulty);
+            score.steps = maze.getPathLength();
+            score.seconds = maze.getElapsedTime();
+            score.timestamp = static_cast<int64_t>(time(nullptr));
+            recorded = true;
+            if (scores.add(score))
+            {
+                scoreLine = "Rank on this maze: #" + to_string(scores.rank(Board::MAZE, score) + 1);
+            }
+            else
+            {
+                scoreLine = "Score could not be saved";
+            }
+        }
+        composeFrame(maze, scoreLine, showProfile, frame);
+        {
+            MAZE_PROFILE_SCOPE("present");
+            frame.present([&terminal](int x, int y, const char *text, int length, ConsoleColor color) {
+                terminal.write(x, y, text, length, color);
+            });
+            terminal.flush();
+        }
+
+        InputEvent event;
+        input.next(event);
+        MAZE_PROFILE_SCOPE("input");
+        recorder.record(event);
+        applyCommand(maze, event.command);
+        switch (event.command)
+        {
+        case Command::RESTART:
+            recorded = false;
+            break;
+        case Command::NEW_MAZE:
+            opts.hasId = false;
+            newMaze();
+            recorded = false;
+            break;
+        case Command::PROFILE:
+            showProfile = !showProfile;
+            break;
+        case Command::QUIT:
+            playing = false;
+            break;
+        default:
+            break;
+        }
+    }
+
+    terminal.resetColor();
+    terminal.showCursor(true);
+    terminal.useAlternateScreen(false);
+    terminal.flush();
+
+    if (!opts.profileJson.empty())
+    {
+        ofstream profile(opts.profileJson);
+        profiler::writeJson(profile);
+    }
+
+    cout << "last maze: " << maze.getId().toString() << " (" << terminal.getWriteCalls() << " writes, "
+         << terminal.getBytesWritten() << " bytes)\n";
+    return 0;
+}